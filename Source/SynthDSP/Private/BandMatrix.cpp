@@ -0,0 +1,156 @@
+#include "SynthDSP/BandMatrix.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SynthDSP
+{
+	namespace
+	{
+		// Two bins is the narrowest triangle that still has a bin on each slope
+		constexpr float MinimumTriangleWidth = 2.0f;
+		constexpr float MinimumWeightSum = 1.0e-4f;
+
+		int32_t ClampBin(int32_t bin, int32_t minimum, int32_t maximum)
+		{
+			return std::min(std::max(bin, minimum), maximum);
+		}
+	}
+
+	FBandMatrix::FBandMatrix()
+	{
+		numBands = 0;
+	}
+
+	void FBandMatrix::Reset()
+	{
+		numBands = 0;
+		rowFirstBin.clear();
+		rowOffsets.assign(1, 0);
+		weights.clear();
+	}
+
+	void FBandMatrix::BuildLinearBuckets(int32_t inNumBands, int32_t halfSize)
+	{
+		Reset();
+		std::vector<float> bucketWeights;
+		for (int32_t band = 0; band < inNumBands; band++)
+		{
+			int32_t firstBin = 1 + (int32_t)(((int64_t)band * halfSize) / inNumBands);
+			int32_t lastBin = 1 + (int32_t)(((int64_t)(band + 1) * halfSize) / inNumBands);
+			firstBin = std::min(firstBin, halfSize);
+			lastBin = ClampBin(lastBin, firstBin + 1, halfSize + 1);
+
+			bucketWeights.assign(lastBin - firstBin, 1.0f / (lastBin - firstBin));
+			AddBand(firstBin, bucketWeights.data(), (int32_t)bucketWeights.size());
+		}
+	}
+
+	void FBandMatrix::BuildHardEdged(const float* edgeBins, int32_t inNumBands, int32_t halfSize)
+	{
+		Reset();
+		std::vector<float> bandWeights;
+		for (int32_t band = 0; band < inNumBands; band++)
+		{
+			const float lowBin = edgeBins[band];
+			const float highBin = edgeBins[band + 1];
+			const int32_t firstBin = ClampBin((int32_t)std::ceil(lowBin), 1, halfSize);
+			const int32_t lastBin = ClampBin((int32_t)std::ceil(highBin), firstBin, halfSize + 1);
+			if (lastBin > firstBin)
+			{
+				bandWeights.assign(lastBin - firstBin, 1.0f / (lastBin - firstBin));
+				AddBand(firstBin, bandWeights.data(), (int32_t)bandWeights.size());
+			}
+			else
+			{
+				// A band narrower than a bin takes its nearest bin
+				const float singleWeight = 1.0f;
+				AddBand(ClampBin((int32_t)std::lround(0.5f * (lowBin + highBin)), 1, halfSize), &singleWeight, 1);
+			}
+		}
+	}
+
+	void FBandMatrix::BuildTriangular(const float* edgeBins, const float* centreBins, int32_t inNumBands, int32_t halfSize)
+	{
+		Reset();
+		std::vector<float> bandWeights;
+		for (int32_t band = 0; band < inNumBands; band++)
+		{
+			const float centreBin = centreBins[band];
+			const float leftBin = band > 0 ? centreBins[band - 1] : edgeBins[band];
+			const float rightBin = band < inNumBands - 1 ? centreBins[band + 1] : edgeBins[band + 1];
+			bandWeights.clear();
+
+			float weightSum = 0.0f;
+			int32_t firstBin = 0;
+			if (rightBin - leftBin >= MinimumTriangleWidth)
+			{
+				firstBin = ClampBin((int32_t)std::ceil(leftBin), 1, halfSize);
+				const int32_t lastBin = ClampBin((int32_t)std::floor(rightBin), firstBin, halfSize);
+				for (int32_t bin = firstBin; bin <= lastBin; bin++)
+				{
+					const float weight = bin <= centreBin
+						? (centreBin > leftBin ? (bin - leftBin) / (centreBin - leftBin) : 1.0f)
+						: (rightBin > centreBin ? (rightBin - bin) / (rightBin - centreBin) : 1.0f);
+					bandWeights.push_back(std::max(weight, 0.0f));
+					weightSum += bandWeights.back();
+				}
+			}
+
+			if (weightSum <= MinimumWeightSum)
+			{
+				// Too narrow to hold a triangle, blend the two bins either side of the centre instead
+				firstBin = ClampBin((int32_t)std::floor(centreBin), 1, halfSize);
+				const float blend = std::min(std::max(centreBin - firstBin, 0.0f), 1.0f);
+				bandWeights.clear();
+				if (firstBin < halfSize)
+				{
+					bandWeights.push_back(1.0f - blend);
+					bandWeights.push_back(blend);
+				}
+				else
+				{
+					bandWeights.push_back(1.0f);
+				}
+				weightSum = 1.0f;
+			}
+
+			for (float& weight : bandWeights) weight /= weightSum;
+			AddBand(firstBin, bandWeights.data(), (int32_t)bandWeights.size());
+		}
+	}
+
+	void FBandMatrix::AddBand(int32_t firstBin, const float* bandWeights, int32_t numWeights)
+	{
+		rowFirstBin.push_back(firstBin);
+		weights.insert(weights.end(), bandWeights, bandWeights + numWeights);
+		rowOffsets.push_back((int32_t)weights.size());
+		numBands++;
+	}
+
+	void FBandMatrix::Apply(const float* SYNTHDSP_RESTRICT binValues, float* SYNTHDSP_RESTRICT outBands) const
+	{
+		const float* allWeights = weights.data();
+		for (int32_t band = 0; band < numBands; band++)
+		{
+			const float* bins = binValues + rowFirstBin[band];
+			const float* rowWeights = allWeights + rowOffsets[band];
+			const int32_t count = rowOffsets[band + 1] - rowOffsets[band];
+
+			int32_t i = 0;
+			float sum = 0.0f;
+			if (count >= 4)
+			{
+				Float4 accumulator = Zero4();
+				for (; i + 4 <= count; i += 4)
+				{
+					accumulator = MultiplyAdd4(Load4(bins + i), Load4(rowWeights + i), accumulator);
+				}
+				sum = HorizontalSum4(accumulator);
+			}
+
+			for (; i < count; i++) sum += bins[i] * rowWeights[i];
+			outBands[band] = sum;
+		}
+	}
+}
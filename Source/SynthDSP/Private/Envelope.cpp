@@ -0,0 +1,48 @@
+#include "SynthDSP/Envelope.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <algorithm>
+
+namespace SynthDSP
+{
+	void UpdateEnvelopes(const float* SYNTHDSP_RESTRICT input, float* SYNTHDSP_RESTRICT envelope, float* SYNTHDSP_RESTRICT peak,
+		float* SYNTHDSP_RESTRICT peakHoldTimers, int32_t count, float deltaTime, const FEnvelopeSettings& settings)
+	{
+		// Rising and falling parts of the difference are split with min/max so the attack/release pick needs no mask
+		const Float4 attack = Set4(settings.attackCoefficient);
+		const Float4 release = Set4(settings.releaseCoefficient);
+		const Float4 peakRelease = Set4(settings.peakReleaseCoefficient);
+		const Float4 holdTime = Set4(settings.peakHoldTime);
+		const Float4 step = Set4(deltaTime);
+		const Float4 zero = Zero4();
+
+		int32_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const Float4 value = Load4(input + i);
+
+			const Float4 currentEnvelope = Load4(envelope + i);
+			const Float4 difference = Subtract4(value, currentEnvelope);
+			Store4(Add4(currentEnvelope, Add4(Multiply4(Max4(difference, zero), attack), Multiply4(Min4(difference, zero), release))), envelope + i);
+
+			const Float4 currentPeak = Load4(peak + i);
+			const Float4 timer = Subtract4(Load4(peakHoldTimers + i), step);
+			const Float4 released = MultiplyAdd4(Subtract4(value, currentPeak), peakRelease, currentPeak);
+			const Float4 heldPeak = Select4(GreaterEqualMask4(zero, timer), released, currentPeak);
+			const Float4 isNewPeak = GreaterEqualMask4(value, heldPeak);
+			Store4(Select4(isNewPeak, value, heldPeak), peak + i);
+			Store4(Select4(isNewPeak, holdTime, timer), peakHoldTimers + i);
+		}
+
+		for (; i < count; i++)
+		{
+			const float difference = input[i] - envelope[i];
+			envelope[i] += std::max(difference, 0.0f) * settings.attackCoefficient + std::min(difference, 0.0f) * settings.releaseCoefficient;
+
+			const float timer = peakHoldTimers[i] - deltaTime;
+			const float heldPeak = timer <= 0.0f ? peak[i] + (input[i] - peak[i]) * settings.peakReleaseCoefficient : peak[i];
+			const bool isNewPeak = input[i] >= heldPeak;
+			peak[i] = isNewPeak ? input[i] : heldPeak;
+			peakHoldTimers[i] = isNewPeak ? settings.peakHoldTime : timer;
+		}
+	}
+}
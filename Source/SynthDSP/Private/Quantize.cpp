@@ -0,0 +1,143 @@
+#include "SynthDSP/Quantize.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(SYNTHDSP_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace SynthDSP
+{
+	namespace
+	{
+		// Half exponent bias moved to float bias, applied as a multiply so zeros and denormals come out right too
+		constexpr float HalfToFloatScale = 5.192296858534828e+33f; // 2^112
+
+		float HalfToFloat(uint16_t half)
+		{
+			const uint32_t shifted = (uint32_t)(half & 0x7FFF) << 13;
+			float magnitude;
+			std::memcpy(&magnitude, &shifted, sizeof(magnitude));
+			magnitude *= HalfToFloatScale;
+
+			uint32_t bits;
+			std::memcpy(&bits, &magnitude, sizeof(bits));
+			bits |= (uint32_t)(half & 0x8000) << 16;
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	}
+
+	void QuantizeUInt8(const float* SYNTHDSP_RESTRICT values, int32_t count, uint8_t* SYNTHDSP_RESTRICT outCodes, float& outScale, float& outOffset)
+	{
+		if (count <= 0)
+		{
+			outScale = 0.0f;
+			outOffset = 0.0f;
+			return;
+		}
+
+		const auto range = std::minmax_element(values, values + count);
+		const float minimum = *range.first;
+		const float span = *range.second - minimum;
+		outOffset = minimum;
+		outScale = span / 255.0f;
+
+		const float inverseScale = span > 0.0f ? 255.0f / span : 0.0f;
+		for (int32_t i = 0; i < count; i++)
+		{
+			const float code = (values[i] - minimum) * inverseScale + 0.5f;
+			outCodes[i] = (uint8_t)std::min(std::max(code, 0.0f), 255.0f);
+		}
+	}
+
+	void DequantizeUInt8(const uint8_t* SYNTHDSP_RESTRICT codes, int32_t count, float scale, float offset, float* SYNTHDSP_RESTRICT outValues)
+	{
+		const Float4 scaleVector = Set4(scale);
+		const Float4 offsetVector = Set4(offset);
+
+		int32_t i = 0;
+#if defined(SYNTHDSP_SIMD_SSE)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4)
+		{
+			int32_t packed;
+			std::memcpy(&packed, codes + i, sizeof(packed));
+			const __m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+			Store4(MultiplyAdd4(_mm_cvtepi32_ps(widened), scaleVector, offsetVector), outValues + i);
+		}
+#elif defined(SYNTHDSP_SIMD_NEON)
+		for (; i + 8 <= count; i += 8)
+		{
+			const uint16x8_t widened = vmovl_u8(vld1_u8(codes + i));
+			Store4(MultiplyAdd4(vcvtq_f32_u32(vmovl_u16(vget_low_u16(widened))), scaleVector, offsetVector), outValues + i);
+			Store4(MultiplyAdd4(vcvtq_f32_u32(vmovl_u16(vget_high_u16(widened))), scaleVector, offsetVector), outValues + i + 4);
+		}
+#endif
+
+		for (; i < count; i++) outValues[i] = codes[i] * scale + offset;
+	}
+
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+		const int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x007FFFFF;
+
+		if (((bits >> 23) & 0xFF) == 0xFF) return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+		if (exponent >= 0x1F) return sign | 0x7C00;
+		if (exponent <= 0)
+		{
+			// Denormal half, or too small for one
+			if (exponent < -10) return sign;
+			mantissa |= 0x00800000;
+			const uint32_t shift = (uint32_t)(14 - exponent);
+			uint32_t halfMantissa = mantissa >> shift;
+			const uint32_t remainder = mantissa & ((1u << shift) - 1);
+			const uint32_t halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) halfMantissa++;
+			return sign | (uint16_t)halfMantissa;
+		}
+
+		// Rounding can carry into the exponent, which is still the right answer (up to infinity)
+		uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+		const uint32_t remainder = mantissa & 0x1FFF;
+		if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++;
+		return sign | (uint16_t)half;
+	}
+
+	void QuantizeHalf(const float* SYNTHDSP_RESTRICT values, int32_t count, uint16_t* SYNTHDSP_RESTRICT outHalves)
+	{
+		for (int32_t i = 0; i < count; i++) outHalves[i] = FloatToHalf(values[i]);
+	}
+
+	void DequantizeHalf(const uint16_t* SYNTHDSP_RESTRICT halves, int32_t count, float* SYNTHDSP_RESTRICT outValues)
+	{
+		int32_t i = 0;
+#if defined(SYNTHDSP_SIMD_SSE)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i magnitudeMask = _mm_set1_epi32(0x7FFF);
+		const __m128i signMask = _mm_set1_epi32(0x8000);
+		const Float4 scale = Set4(HalfToFloatScale);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i widened = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(halves + i)), zero);
+			const Float4 magnitude = Multiply4(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(widened, magnitudeMask), 13)), scale);
+			const __m128i sign = _mm_slli_epi32(_mm_and_si128(widened, signMask), 16);
+			Store4(_mm_or_ps(magnitude, _mm_castsi128_ps(sign)), outValues + i);
+		}
+#elif defined(SYNTHDSP_SIMD_NEON) && defined(__aarch64__)
+		for (; i + 4 <= count; i += 4)
+		{
+			Store4(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(halves + i))), outValues + i);
+		}
+#endif
+
+		for (; i < count; i++) outValues[i] = HalfToFloat(halves[i]);
+	}
+}
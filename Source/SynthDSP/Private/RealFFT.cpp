@@ -0,0 +1,135 @@
+#include "SynthDSP/RealFFT.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <cmath>
+
+namespace SynthDSP
+{
+	namespace
+	{
+		constexpr float Pi = 3.14159265358979323846f;
+
+		int32_t FloorLog2(int32_t value)
+		{
+			int32_t log = 0;
+			while ((value >> (log + 1)) > 0) log++;
+			return log;
+		}
+	}
+
+	FRealFFT::FRealFFT()
+	{
+		fftSize = 0;
+		halfSize = 0;
+	}
+
+	void FRealFFT::Prepare(int32_t inFFTSize)
+	{
+		if (inFFTSize == fftSize) return;
+
+		fftSize = inFFTSize;
+		halfSize = fftSize / 2;
+
+		const int32_t numBits = FloorLog2(halfSize);
+		bitReverse.resize(halfSize);
+		for (int32_t i = 0; i < halfSize; i++)
+		{
+			int32_t reversed = 0;
+			for (int32_t bit = 0; bit < numBits; bit++)
+			{
+				reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+			}
+			bitReverse[i] = reversed;
+		}
+
+		// Twiddles are stored contiguously per stage so each butterfly pass reads them linearly
+		stageTwiddleReal.resize(halfSize > 1 ? halfSize - 1 : 1);
+		stageTwiddleImag.resize(halfSize > 1 ? halfSize - 1 : 1);
+		for (int32_t span = 1; span < halfSize; span <<= 1)
+		{
+			for (int32_t k = 0; k < span; k++)
+			{
+				const float angle = -Pi * k / span;
+				stageTwiddleReal[span - 1 + k] = std::cos(angle);
+				stageTwiddleImag[span - 1 + k] = std::sin(angle);
+			}
+		}
+
+		splitTwiddleReal.resize(halfSize);
+		splitTwiddleImag.resize(halfSize);
+		for (int32_t k = 0; k < halfSize; k++)
+		{
+			const float angle = -2.0f * Pi * k / fftSize;
+			splitTwiddleReal[k] = std::cos(angle);
+			splitTwiddleImag[k] = std::sin(angle);
+		}
+
+		real.resize(halfSize);
+		imag.resize(halfSize);
+	}
+
+	void FRealFFT::Forward()
+	{
+		float* re = real.data();
+		float* im = imag.data();
+
+		for (int32_t span = 1; span < halfSize; span <<= 1)
+		{
+			const float* twiddleRe = stageTwiddleReal.data() + span - 1;
+			const float* twiddleIm = stageTwiddleImag.data() + span - 1;
+
+			for (int32_t block = 0; block < halfSize; block += 2 * span)
+			{
+				float* aRe = re + block;
+				float* aIm = im + block;
+				float* bRe = aRe + span;
+				float* bIm = aIm + span;
+
+				int32_t k = 0;
+				for (; k + 4 <= span; k += 4)
+				{
+					const Float4 wRe = Load4(twiddleRe + k);
+					const Float4 wIm = Load4(twiddleIm + k);
+					const Float4 xRe = Load4(bRe + k);
+					const Float4 xIm = Load4(bIm + k);
+					const Float4 tRe = Subtract4(Multiply4(wRe, xRe), Multiply4(wIm, xIm));
+					const Float4 tIm = MultiplyAdd4(wRe, xIm, Multiply4(wIm, xRe));
+					const Float4 yRe = Load4(aRe + k);
+					const Float4 yIm = Load4(aIm + k);
+					Store4(Add4(yRe, tRe), aRe + k);
+					Store4(Add4(yIm, tIm), aIm + k);
+					Store4(Subtract4(yRe, tRe), bRe + k);
+					Store4(Subtract4(yIm, tIm), bIm + k);
+				}
+
+				for (; k < span; k++)
+				{
+					const float tRe = twiddleRe[k] * bRe[k] - twiddleIm[k] * bIm[k];
+					const float tIm = twiddleRe[k] * bIm[k] + twiddleIm[k] * bRe[k];
+					bRe[k] = aRe[k] - tRe;
+					bIm[k] = aIm[k] - tIm;
+					aRe[k] += tRe;
+					aIm[k] += tIm;
+				}
+			}
+		}
+	}
+
+	void FRealFFT::PowerSpectrum(float* outPower) const
+	{
+		// Split the half size complex result back into the real input spectrum
+		for (int32_t k = 0; k < halfSize; k++)
+		{
+			const int32_t mirror = (halfSize - k) & (halfSize - 1);
+			const float evenRe = 0.5f * (real[k] + real[mirror]);
+			const float evenIm = 0.5f * (imag[k] - imag[mirror]);
+			const float oddRe = 0.5f * (imag[k] + imag[mirror]);
+			const float oddIm = -0.5f * (real[k] - real[mirror]);
+			const float binRe = evenRe + splitTwiddleReal[k] * oddRe - splitTwiddleImag[k] * oddIm;
+			const float binIm = evenIm + splitTwiddleReal[k] * oddIm + splitTwiddleImag[k] * oddRe;
+			outPower[k] = binRe * binRe + binIm * binIm;
+		}
+
+		const float nyquist = real[0] - imag[0];
+		outPower[halfSize] = nyquist * nyquist;
+	}
+}
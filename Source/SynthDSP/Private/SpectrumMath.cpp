@@ -0,0 +1,66 @@
+#include "SynthDSP/SpectrumMath.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SynthDSP
+{
+	namespace
+	{
+		constexpr float DecibelScale = 4.342944819f; // 10 / ln(10)
+	}
+
+	void PowerToDecibels(float* values, int32_t count, float powerScale, float minimumPower)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			values[i] = DecibelScale * std::log(std::max(values[i] * powerScale, minimumPower));
+		}
+	}
+
+	void NormalizeSpectrum(const float* SYNTHDSP_RESTRICT decibels, float* SYNTHDSP_RESTRICT outNormalized, int32_t count, float clamp, float powerFactor)
+	{
+		// (clamp(x) + c) / 2c folded into one multiply add
+		const float scale = 1.0f / (2.0f * clamp);
+		const Float4 clampMin = Set4(-clamp);
+		const Float4 clampMax = Set4(clamp);
+		const Float4 scaleVector = Set4(scale);
+		const Float4 offsetVector = Set4(0.5f);
+
+		// Small whole powers (the common case, default is 2) are just multiplies
+		const int32_t integerPower = (int32_t)std::lround(powerFactor);
+		const bool isIntegerPower = integerPower >= 1 && integerPower <= 4 && (float)integerPower == powerFactor;
+		const Float4 powerVector = Set4(powerFactor);
+
+		int32_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const Float4 normalized = MultiplyAdd4(Min4(Max4(Load4(decibels + i), clampMin), clampMax), scaleVector, offsetVector);
+			Float4 powered = normalized;
+			if (isIntegerPower)
+			{
+				for (int32_t power = 1; power < integerPower; power++) powered = Multiply4(powered, normalized);
+			}
+			else
+			{
+				powered = FastExp2_4(Multiply4(powerVector, FastLog2_4(normalized)));
+			}
+			Store4(powered, outNormalized + i);
+		}
+
+		for (; i < count; i++)
+		{
+			const float normalized = std::min(std::max(decibels[i], -clamp), clamp) * scale + 0.5f;
+			float powered = normalized;
+			if (isIntegerPower)
+			{
+				for (int32_t power = 1; power < integerPower; power++) powered *= normalized;
+			}
+			else
+			{
+				powered = FastExp2(powerFactor * FastLog2(normalized));
+			}
+			outNormalized[i] = powered;
+		}
+	}
+}
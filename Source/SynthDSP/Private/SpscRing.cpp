@@ -0,0 +1,68 @@
+#include "SynthDSP/SpscRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SynthDSP
+{
+	FSpscRing::FSpscRing()
+	{
+		capacity = 0;
+		mask = 0;
+		writeIndex = 0;
+		readIndex = 0;
+	}
+
+	void FSpscRing::Reset(int32_t inCapacity)
+	{
+		capacity = 1;
+		while (capacity < (uint32_t)std::max(inCapacity, 1)) capacity <<= 1;
+		mask = capacity - 1;
+		buffer.assign(capacity, 0.0f);
+		writeIndex.store(0, std::memory_order_relaxed);
+		readIndex.store(0, std::memory_order_relaxed);
+	}
+
+	int32_t FSpscRing::Write(const float* samples, int32_t count)
+	{
+		// Only the producer moves writeIndex, the acquire on readIndex makes sure the reader is done with the space
+		const uint32_t write = writeIndex.load(std::memory_order_relaxed);
+		const uint32_t read = readIndex.load(std::memory_order_acquire);
+		const uint32_t toWrite = std::min((uint32_t)std::max(count, 0), capacity - (write - read));
+
+		const uint32_t start = write & mask;
+		const uint32_t firstRun = std::min(toWrite, capacity - start);
+		std::memcpy(buffer.data() + start, samples, firstRun * sizeof(float));
+		std::memcpy(buffer.data(), samples + firstRun, (toWrite - firstRun) * sizeof(float));
+
+		writeIndex.store(write + toWrite, std::memory_order_release);
+		return (int32_t)toWrite;
+	}
+
+	int32_t FSpscRing::Read(float* outSamples, int32_t maxCount)
+	{
+		const uint32_t read = readIndex.load(std::memory_order_relaxed);
+		const uint32_t write = writeIndex.load(std::memory_order_acquire);
+		const uint32_t toRead = std::min((uint32_t)std::max(maxCount, 0), write - read);
+
+		const uint32_t start = read & mask;
+		const uint32_t firstRun = std::min(toRead, capacity - start);
+		std::memcpy(outSamples, buffer.data() + start, firstRun * sizeof(float));
+		std::memcpy(outSamples + firstRun, buffer.data(), (toRead - firstRun) * sizeof(float));
+
+		readIndex.store(read + toRead, std::memory_order_release);
+		return (int32_t)toRead;
+	}
+
+	void FSpscRing::Skip(int32_t keepCount)
+	{
+		const uint32_t read = readIndex.load(std::memory_order_relaxed);
+		const uint32_t write = writeIndex.load(std::memory_order_acquire);
+		const uint32_t keep = (uint32_t)std::max(keepCount, 0);
+		if (write - read > keep) readIndex.store(write - keep, std::memory_order_release);
+	}
+
+	int32_t FSpscRing::GetNumReadable() const
+	{
+		return (int32_t)(writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed));
+	}
+}
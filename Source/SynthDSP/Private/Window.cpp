@@ -0,0 +1,39 @@
+#include "SynthDSP/Window.h"
+#include <cmath>
+
+namespace SynthDSP
+{
+	namespace
+	{
+		constexpr float Pi = 3.14159265358979323846f;
+	}
+
+	float EvaluateWindow(EWindowType windowType, int32_t index, int32_t size)
+	{
+		const float phase = (2.0f * Pi * index) / size;
+		switch (windowType)
+		{
+		case EWindowType::Hann:
+			return 0.5f - 0.5f * std::cos(phase);
+		case EWindowType::Hamming:
+			return 0.54f - 0.46f * std::cos(phase);
+		case EWindowType::Blackman:
+			return 0.42f - 0.5f * std::cos(phase) + 0.08f * std::cos(2.0f * phase);
+		default:
+			return 1.0f;
+		}
+	}
+
+	void BuildWindow(EWindowType windowType, int32_t size, float gain, float* outWindow)
+	{
+		float windowSum = 0.0f;
+		for (int32_t i = 0; i < size; i++)
+		{
+			outWindow[i] = EvaluateWindow(windowType, i, size);
+			windowSum += outWindow[i];
+		}
+
+		const float windowScale = windowSum > 0.0f ? gain * size / windowSum : gain;
+		for (int32_t i = 0; i < size; i++) outWindow[i] *= windowScale;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <vector>
+
+namespace SynthDSP
+{
+	/**
+	 * Sparse bin -> band weights.
+	 * Every band reads a contiguous run of bins, so a row is just a first bin plus a run of weights.
+	 * Edges and centres are in fractional bin units (bin k sits at k * sampleRate / fftSize Hz).
+	 */
+	class SYNTHDSP_API FBandMatrix
+	{
+	public:
+		FBandMatrix();
+
+		void Reset();
+		// The original DC skipping buckets, numBands even slices of bins 1 to halfSize
+		void BuildLinearBuckets(int32_t numBands, int32_t halfSize);
+		// Every bin centred inside a band counts equally, edgeBins holds numBands + 1 ascending edges
+		void BuildHardEdged(const float* edgeBins, int32_t numBands, int32_t halfSize);
+		// Triangles peak at centreBins[band] and reach zero at the neighbouring centres (the outer edges at either end)
+		void BuildTriangular(const float* edgeBins, const float* centreBins, int32_t numBands, int32_t halfSize);
+
+		void Apply(const float* SYNTHDSP_RESTRICT binValues, float* SYNTHDSP_RESTRICT outBands) const;
+		int32_t GetNumBands() const { return numBands; }
+
+	private:
+		void AddBand(int32_t firstBin, const float* bandWeights, int32_t numWeights);
+
+	private:
+		int32_t numBands;
+		std::vector<int32_t> rowFirstBin;
+		std::vector<int32_t> rowOffsets;
+		std::vector<float> weights;
+	};
+}
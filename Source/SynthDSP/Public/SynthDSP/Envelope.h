@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <cmath>
+
+namespace SynthDSP
+{
+	// One pole smoothing coefficient for a step of deltaTime, reaching 63% of a change in timeConstant seconds.
+	// Built from the elapsed time so the response is the same at any frame rate, a zero time constant passes input through.
+	inline float EnvelopeCoefficient(float timeConstant, float deltaTime)
+	{
+		return timeConstant > 0.0f ? 1.0f - std::exp(-deltaTime / timeConstant) : 1.0f;
+	}
+
+	struct FEnvelopeSettings
+	{
+		float attackCoefficient;
+		float releaseCoefficient;
+		// Peak hold: seconds a peak is held before it releases towards the input
+		float peakHoldTime;
+		float peakReleaseCoefficient;
+	};
+
+	/**
+	 * Attack/release envelope and peak hold over count bins in one pass.
+	 * envelope moves towards input at the attack rate when rising and the release rate when falling.
+	 * peak jumps to any input above it and restarts its hold timer, once the timer runs out it releases towards the input.
+	 */
+	SYNTHDSP_API void UpdateEnvelopes(const float* SYNTHDSP_RESTRICT input, float* SYNTHDSP_RESTRICT envelope, float* SYNTHDSP_RESTRICT peak,
+		float* SYNTHDSP_RESTRICT peakHoldTimers, int32_t count, float deltaTime, const FEnvelopeSettings& settings);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+
+namespace SynthDSP
+{
+	// 8 bit codes spanning [min, max] of the values, value ~= offset + code * scale. Error is at most scale / 2
+	SYNTHDSP_API void QuantizeUInt8(const float* SYNTHDSP_RESTRICT values, int32_t count, uint8_t* SYNTHDSP_RESTRICT outCodes, float& outScale, float& outOffset);
+	SYNTHDSP_API void DequantizeUInt8(const uint8_t* SYNTHDSP_RESTRICT codes, int32_t count, float scale, float offset, float* SYNTHDSP_RESTRICT outValues);
+
+	// IEEE half precision, round to nearest even. Dequantize assumes finite values, which is all a spectrum holds
+	SYNTHDSP_API uint16_t FloatToHalf(float value);
+	SYNTHDSP_API void QuantizeHalf(const float* SYNTHDSP_RESTRICT values, int32_t count, uint16_t* SYNTHDSP_RESTRICT outHalves);
+	SYNTHDSP_API void DequantizeHalf(const uint16_t* SYNTHDSP_RESTRICT halves, int32_t count, float* SYNTHDSP_RESTRICT outValues);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <vector>
+
+namespace SynthDSP
+{
+	/**
+	 * Power of two real-input FFT, run as a half size complex FFT over interleaved even/odd samples.
+	 * Tables are built once per size in Prepare, Forward and PowerSpectrum never allocate.
+	 */
+	class SYNTHDSP_API FRealFFT
+	{
+	public:
+		FRealFFT();
+
+		// fftSize must be a power of two, 4 or more
+		void Prepare(int32_t inFFTSize);
+		int32_t GetSize() const { return fftSize; }
+		int32_t GetHalfSize() const { return halfSize; }
+
+		// Scales and windows one frame into the bit reversed input, samples at or past numAvailable are zero padded
+		template<typename SampleType>
+		void LoadFrame(const SampleType* frame, int32_t numAvailable, float sampleScale, const float* window);
+		void Forward();
+		// |X[k]|^2 for bins 0 to halfSize inclusive
+		void PowerSpectrum(float* outPower) const;
+
+	private:
+		int32_t fftSize;
+		int32_t halfSize;
+
+		std::vector<int32_t> bitReverse;
+		std::vector<float> stageTwiddleReal;
+		std::vector<float> stageTwiddleImag;
+		std::vector<float> splitTwiddleReal;
+		std::vector<float> splitTwiddleImag;
+
+		std::vector<float> real;
+		std::vector<float> imag;
+	};
+
+	template<typename SampleType>
+	void FRealFFT::LoadFrame(const SampleType* frame, int32_t numAvailable, float sampleScale, const float* window)
+	{
+		for (int32_t i = 0; i < halfSize; i++)
+		{
+			const int32_t even = 2 * i;
+			const int32_t odd = even + 1;
+			const int32_t target = bitReverse[i];
+			real[target] = even < numAvailable ? frame[even] * sampleScale * window[even] : 0.0f;
+			imag[target] = odd < numAvailable ? frame[odd] * sampleScale * window[odd] : 0.0f;
+		}
+	}
+}
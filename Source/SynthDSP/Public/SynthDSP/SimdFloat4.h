@@ -0,0 +1,158 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SYNTHDSP_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SYNTHDSP_SIMD_NEON 1
+#endif
+
+/**
+ * Four wide float helpers, the subset of VectorRegister the kernels use.
+ * Loads and stores are unaligned, the kernels work on arbitrary offsets into their buffers.
+ */
+namespace SynthDSP
+{
+#if defined(SYNTHDSP_SIMD_SSE)
+	typedef __m128 Float4;
+
+	inline Float4 Load4(const float* source) { return _mm_loadu_ps(source); }
+	inline void Store4(Float4 value, float* destination) { _mm_storeu_ps(destination, value); }
+	inline Float4 Set4(float value) { return _mm_set1_ps(value); }
+	inline Float4 Zero4() { return _mm_setzero_ps(); }
+	inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+	inline Float4 Subtract4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+	inline Float4 Multiply4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+	inline Float4 MultiplyAdd4(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	inline Float4 Min4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+	inline Float4 Max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+	// Lanes where a >= b are all ones, for Select4
+	inline Float4 GreaterEqualMask4(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+	inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline Float4 Divide4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+	// Rounds towards zero
+	inline Float4 Truncate4(Float4 value) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(value)); }
+	// Bitwise, for masks built with SetBits4
+	inline Float4 SetBits4(uint32_t bits) { return _mm_castsi128_ps(_mm_set1_epi32((int32_t)bits)); }
+	inline Float4 And4(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+	inline Float4 Or4(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+	// Each lane's bit pattern read as an int32 and converted to float, and the reverse (truncating)
+	inline Float4 IntBitsToFloat4(Float4 value) { return _mm_cvtepi32_ps(_mm_castps_si128(value)); }
+	inline Float4 FloatToIntBits4(Float4 value) { return _mm_castsi128_ps(_mm_cvttps_epi32(value)); }
+#elif defined(SYNTHDSP_SIMD_NEON)
+	typedef float32x4_t Float4;
+
+	inline Float4 Load4(const float* source) { return vld1q_f32(source); }
+	inline void Store4(Float4 value, float* destination) { vst1q_f32(destination, value); }
+	inline Float4 Set4(float value) { return vdupq_n_f32(value); }
+	inline Float4 Zero4() { return vdupq_n_f32(0.0f); }
+	inline Float4 Add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+	inline Float4 Subtract4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+	inline Float4 Multiply4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+	inline Float4 MultiplyAdd4(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(c, a, b); }
+	inline Float4 Min4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+	inline Float4 Max4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+	inline Float4 GreaterEqualMask4(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+	inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+	inline Float4 Divide4(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+#else
+	// No divide on 32 bit NEON, the estimate refined twice is within a couple of ulp
+	inline Float4 Divide4(Float4 a, Float4 b)
+	{
+		float32x4_t reciprocal = vrecpeq_f32(b);
+		reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b, reciprocal));
+		reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b, reciprocal));
+		return vmulq_f32(a, reciprocal);
+	}
+#endif
+	inline Float4 Truncate4(Float4 value) { return vcvtq_f32_s32(vcvtq_s32_f32(value)); }
+	inline Float4 SetBits4(uint32_t bits) { return vreinterpretq_f32_u32(vdupq_n_u32(bits)); }
+	inline Float4 And4(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+	inline Float4 Or4(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+	inline Float4 IntBitsToFloat4(Float4 value) { return vcvtq_f32_s32(vreinterpretq_s32_f32(value)); }
+	inline Float4 FloatToIntBits4(Float4 value) { return vreinterpretq_f32_s32(vcvtq_s32_f32(value)); }
+#else
+	struct Float4 { float lanes[4]; };
+
+	inline Float4 Load4(const float* source) { return { { source[0], source[1], source[2], source[3] } }; }
+	inline void Store4(Float4 value, float* destination) { for (int i = 0; i < 4; i++) destination[i] = value.lanes[i]; }
+	inline Float4 Set4(float value) { return { { value, value, value, value } }; }
+	inline Float4 Zero4() { return Set4(0.0f); }
+	inline Float4 Add4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] += b.lanes[i]; return a; }
+	inline Float4 Subtract4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] -= b.lanes[i]; return a; }
+	inline Float4 Multiply4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] *= b.lanes[i]; return a; }
+	inline Float4 MultiplyAdd4(Float4 a, Float4 b, Float4 c) { for (int i = 0; i < 4; i++) c.lanes[i] += a.lanes[i] * b.lanes[i]; return c; }
+	inline Float4 Min4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] = a.lanes[i] < b.lanes[i] ? a.lanes[i] : b.lanes[i]; return a; }
+	inline Float4 Max4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] = a.lanes[i] > b.lanes[i] ? a.lanes[i] : b.lanes[i]; return a; }
+	// Scalar masks are 1 or 0 per lane rather than a bit pattern, only Select4 reads them
+	inline Float4 GreaterEqualMask4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] = a.lanes[i] >= b.lanes[i] ? 1.0f : 0.0f; return a; }
+	inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] = mask.lanes[i] != 0.0f ? a.lanes[i] : b.lanes[i]; return a; }
+	inline Float4 Divide4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.lanes[i] /= b.lanes[i]; return a; }
+	inline Float4 Truncate4(Float4 value) { for (int i = 0; i < 4; i++) value.lanes[i] = (float)(int32_t)value.lanes[i]; return value; }
+	inline Float4 SetBits4(uint32_t bits) { float value; std::memcpy(&value, &bits, sizeof(value)); return Set4(value); }
+	inline Float4 And4(Float4 a, Float4 b)
+	{
+		uint32_t bitsA[4], bitsB[4];
+		std::memcpy(bitsA, a.lanes, sizeof(bitsA));
+		std::memcpy(bitsB, b.lanes, sizeof(bitsB));
+		for (int i = 0; i < 4; i++) bitsA[i] &= bitsB[i];
+		std::memcpy(a.lanes, bitsA, sizeof(bitsA));
+		return a;
+	}
+	inline Float4 Or4(Float4 a, Float4 b)
+	{
+		uint32_t bitsA[4], bitsB[4];
+		std::memcpy(bitsA, a.lanes, sizeof(bitsA));
+		std::memcpy(bitsB, b.lanes, sizeof(bitsB));
+		for (int i = 0; i < 4; i++) bitsA[i] |= bitsB[i];
+		std::memcpy(a.lanes, bitsA, sizeof(bitsA));
+		return a;
+	}
+	inline Float4 IntBitsToFloat4(Float4 value)
+	{
+		int32_t bits[4];
+		std::memcpy(bits, value.lanes, sizeof(bits));
+		for (int i = 0; i < 4; i++) value.lanes[i] = (float)bits[i];
+		return value;
+	}
+	inline Float4 FloatToIntBits4(Float4 value)
+	{
+		int32_t bits[4];
+		for (int i = 0; i < 4; i++) bits[i] = (int32_t)value.lanes[i];
+		std::memcpy(value.lanes, bits, sizeof(bits));
+		return value;
+	}
+#endif
+
+	inline float HorizontalSum4(Float4 value)
+	{
+		float lanes[4];
+		Store4(value, lanes);
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+
+	// Four wide FastLog2 (SpectrumMath.h), same constants and operation order. Lanes must be non negative.
+	inline Float4 FastLog2_4(Float4 x)
+	{
+		const Float4 mantissa = Or4(And4(x, SetBits4(0x007FFFFF)), SetBits4(0x3f000000));
+		const Float4 exponent = Multiply4(IntBitsToFloat4(x), Set4(1.1920928955078125e-7f));
+		const Float4 linear = Subtract4(Subtract4(exponent, Set4(124.22551499f)), Multiply4(Set4(1.498030302f), mantissa));
+		return Subtract4(linear, Divide4(Set4(1.72587999f), Add4(Set4(0.3520887068f), mantissa)));
+	}
+
+	// Four wide FastExp2 (SpectrumMath.h), same constants and operation order
+	inline Float4 FastExp2_4(Float4 p)
+	{
+		const Float4 clipped = Max4(p, Set4(-126.0f));
+		const Float4 negativeOffset = Select4(GreaterEqualMask4(clipped, Zero4()), Zero4(), Set4(1.0f));
+		const Float4 fraction = Add4(Subtract4(clipped, Truncate4(clipped)), negativeOffset);
+		const Float4 curve = Add4(Add4(clipped, Set4(121.2740575f)), Divide4(Set4(27.7280233f), Subtract4(Set4(4.84252568f), fraction)));
+		return FloatToIntBits4(Multiply4(Set4((float)(1 << 23)), Subtract4(curve, Multiply4(Set4(1.49012907f), fraction))));
+	}
+}
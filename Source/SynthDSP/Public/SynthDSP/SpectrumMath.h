@@ -0,0 +1,35 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <cstring>
+
+namespace SynthDSP
+{
+	// Approximations of log2/exp2 (max abs error ~3e-4 over [0, 1]), plenty for a visual power curve
+	inline float FastLog2(float x)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		const uint32_t mantissaBits = (bits & 0x007FFFFF) | 0x3f000000;
+		float mantissa;
+		std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+		const float exponent = bits * 1.1920928955078125e-7f;
+		return exponent - 124.22551499f - 1.498030302f * mantissa - 1.72587999f / (0.3520887068f + mantissa);
+	}
+
+	inline float FastExp2(float p)
+	{
+		const float clipped = p > -126.0f ? p : -126.0f;
+		const float fraction = clipped - (int32_t)clipped + (clipped < 0.0f ? 1.0f : 0.0f);
+		const uint32_t bits = (uint32_t)((1 << 23) * (clipped + 121.2740575f + 27.7280233f / (4.84252568f - fraction) - 1.49012907f * fraction));
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// In place 10 * log10(max(power * powerScale, minimumPower))
+	SYNTHDSP_API void PowerToDecibels(float* values, int32_t count, float powerScale, float minimumPower);
+
+	// ((clamp(x, -c, c) + c) / 2c) ^ powerFactor, small whole powers are exact and the rest go through FastLog2/FastExp2
+	SYNTHDSP_API void NormalizeSpectrum(const float* SYNTHDSP_RESTRICT decibels, float* SYNTHDSP_RESTRICT outNormalized, int32_t count, float clamp, float powerFactor);
+}
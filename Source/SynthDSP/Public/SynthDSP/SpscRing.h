@@ -0,0 +1,40 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+#include <atomic>
+#include <vector>
+
+namespace SynthDSP
+{
+	/**
+	 * Lock free single producer, single consumer ring of float samples.
+	 * One thread writes (the audio render thread), one thread reads (the analyzer). Neither side locks or allocates,
+	 * storage is only sized in Reset, which must not race either side.
+	 */
+	class SYNTHDSP_API FSpscRing
+	{
+	public:
+		FSpscRing();
+
+		// Capacity is rounded up to a power of two, clears anything buffered
+		void Reset(int32_t inCapacity);
+		int32_t GetCapacity() const { return (int32_t)capacity; }
+
+		// Producer. Writes what fits and drops the rest, returns the number written
+		int32_t Write(const float* samples, int32_t count);
+		// Consumer. Reads up to maxCount of the oldest samples, returns the number read
+		int32_t Read(float* outSamples, int32_t maxCount);
+		// Consumer. Drops all but the newest keepCount samples so a stalled reader catches up instead of lagging
+		void Skip(int32_t keepCount);
+		int32_t GetNumReadable() const;
+
+	private:
+		std::vector<float> buffer;
+		uint32_t capacity;
+		uint32_t mask;
+
+		// Free running indices, on separate cache lines so the two threads don't false share
+		alignas(64) std::atomic<uint32_t> writeIndex;
+		alignas(64) std::atomic<uint32_t> readIndex;
+	};
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// UnrealBuildTool defines the export macro, standalone builds of the kernels don't need one
+#ifndef SYNTHDSP_API
+#define SYNTHDSP_API
+#endif
+
+#if defined(_MSC_VER)
+#define SYNTHDSP_RESTRICT __restrict
+#else
+#define SYNTHDSP_RESTRICT __restrict__
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "SynthDSP/SynthDSPConfig.h"
+
+namespace SynthDSP
+{
+	// Same order as ESpectrumWindowType so the engine side can cast straight across
+	enum class EWindowType : uint8_t
+	{
+		Rectangular,
+		Hann,
+		Hamming,
+		Blackman
+	};
+
+	SYNTHDSP_API float EvaluateWindow(EWindowType windowType, int32_t index, int32_t size);
+
+	// Periodic window with its coherent gain divided out and gain folded in, so a window never shifts the level of a tone
+	SYNTHDSP_API void BuildWindow(EWindowType windowType, int32_t size, float gain, float* outWindow);
+}
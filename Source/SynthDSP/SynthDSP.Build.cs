@@ -0,0 +1,14 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class SynthDSP : ModuleRules
+{
+	public SynthDSP(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Only the module boilerplate touches the engine, every kernel under Public/SynthDSP is plain C++
+		PrivateDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
@@ -9,6 +9,6 @@ public class SynthVisualizerTarget : TargetRules
 	{
 		Type = TargetType.Game;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
-		ExtraModuleNames.AddRange( new string[] { "SynthVisualizer" } );
+		ExtraModuleNames.AddRange( new string[] { "SynthVisualizer", "SynthDSP" } );
 	}
 }
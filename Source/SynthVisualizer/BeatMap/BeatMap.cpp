@@ -0,0 +1,234 @@
+#include "BeatMap.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Reverse.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+
+namespace
+{
+	// Onset peak picking, in seconds and fractions of the loudest flux in the track
+	constexpr float OnsetPeakRadius = 0.03f;
+	constexpr float OnsetMeanRadius = 0.1f;
+	constexpr float OnsetMinimumInterval = 0.05f;
+	constexpr float OnsetThresholdOffset = 0.07f;
+
+	// Tempo search range and the log2 spread of the prior centred on 120 BPM
+	constexpr float MinimumTempo = 60.0f;
+	constexpr float MaximumTempo = 200.0f;
+	constexpr float PreferredTempo = 120.0f;
+	constexpr float TempoPriorSpread = 1.0f;
+
+	// How hard beat tracking punishes a gap that strays from the tempo period
+	constexpr float BeatTightness = 100.0f;
+
+	float GetMusicEventTime(const FMusicEvent& musicEvent) { return musicEvent.time; }
+
+	// Offset of a peak from its sample, fitted through the neighbours
+	float ParabolicPeakOffset(float previous, float peak, float next)
+	{
+		const float curvature = previous - 2.0f * peak + next;
+		return curvature < 0.0f ? FMath::Clamp(0.5f * (previous - next) / curvature, -0.5f, 0.5f) : 0.0f;
+	}
+}
+
+FBeatMap::FBeatMap()
+{
+	tempo = 0.0f;
+	nextOnset = 0;
+	nextBeat = 0;
+	cursorTime = 0.0f;
+}
+
+void FBeatMap::Reset()
+{
+	onsets.Empty();
+	beats.Empty();
+	tempo = 0.0f;
+	nextOnset = 0;
+	nextBeat = 0;
+	cursorTime = 0.0f;
+}
+
+void FBeatMap::Build(const FSpectrogram& spectrogram, float timeSlice)
+{
+	Reset();
+	if (!spectrogram.IsValid() || spectrogram.numFrames < 3 || spectrogram.frameRate <= 0.0f) return;
+
+	// Rectified spectral flux in dB, frame t measures what arrived since frame t - 1 and which band it arrived in
+	const int32 numFrames = spectrogram.numFrames;
+	const int32 numBins = spectrogram.numBins;
+	TArray<float> flux;
+	TArray<int32> fluxBand;
+	flux.SetNumZeroed(numFrames);
+	fluxBand.SetNumZeroed(numFrames);
+
+	// Frames may be stored quantized, so each one is read out once and the previous read is kept
+	TArray<float> previousFrame;
+	TArray<float> currentFrame;
+	previousFrame.SetNumUninitialized(numBins);
+	currentFrame.SetNumUninitialized(numBins);
+	spectrogram.ReadFrame(0, currentFrame.GetData());
+
+	float maxFlux = 0.0f;
+	for (int32 frame = 1; frame < numFrames; frame++)
+	{
+		Swap(previousFrame, currentFrame);
+		spectrogram.ReadFrame(frame, currentFrame.GetData());
+		const float* previous = previousFrame.GetData();
+		const float* current = currentFrame.GetData();
+		float frameFlux = 0.0f;
+		float bandFlux = 0.0f;
+		for (int32 bin = 0; bin < numBins; bin++)
+		{
+			const float rise = current[bin] - previous[bin];
+			if (rise <= 0.0f) continue;
+
+			frameFlux += rise;
+			if (rise > bandFlux)
+			{
+				bandFlux = rise;
+				fluxBand[frame] = bin;
+			}
+		}
+
+		flux[frame] = frameFlux;
+		maxFlux = FMath::Max(maxFlux, frameFlux);
+	}
+
+	if (maxFlux <= 0.0f) return;
+	for (float& frameFlux : flux) frameFlux /= maxFlux;
+
+	// The flux of frame t sits between frames t - 1 and t, in the middle of the analysis window
+	const float timeOffset = 0.5f * timeSlice - 0.5f / spectrogram.frameRate;
+	DetectOnsets(flux, fluxBand, spectrogram.frameRate, timeOffset);
+	TrackBeats(flux, fluxBand, spectrogram.frameRate, timeOffset);
+}
+
+void FBeatMap::DetectOnsets(const TArray<float>& flux, const TArray<int32>& fluxBand, float frameRate, float timeOffset)
+{
+	const int32 numFrames = flux.Num();
+	const int32 peakRadius = FMath::Max(1, FMath::RoundToInt(OnsetPeakRadius * frameRate));
+	const int32 meanRadius = FMath::Max(1, FMath::RoundToInt(OnsetMeanRadius * frameRate));
+	const int32 minimumGap = FMath::Max(1, FMath::RoundToInt(OnsetMinimumInterval * frameRate));
+
+	// Prefix sums so the moving average threshold is O(1) per frame
+	TArray<float> fluxSum;
+	fluxSum.SetNumUninitialized(numFrames + 1);
+	fluxSum[0] = 0.0f;
+	for (int32 frame = 0; frame < numFrames; frame++) fluxSum[frame + 1] = fluxSum[frame] + flux[frame];
+
+	int32 lastOnset = -minimumGap;
+	for (int32 frame = 1; frame < numFrames; frame++)
+	{
+		if (frame - lastOnset < minimumGap) continue;
+
+		const int32 meanStart = FMath::Max(0, frame - meanRadius);
+		const int32 meanEnd = FMath::Min(numFrames, frame + meanRadius + 1);
+		const float threshold = (fluxSum[meanEnd] - fluxSum[meanStart]) / (meanEnd - meanStart) + OnsetThresholdOffset;
+		if (flux[frame] <= threshold) continue;
+
+		// Strictly above everything before it so a plateau only fires once
+		bool isPeak = true;
+		for (int32 neighbour = FMath::Max(0, frame - peakRadius); neighbour <= FMath::Min(numFrames - 1, frame + peakRadius) && isPeak; neighbour++)
+		{
+			if (neighbour < frame) isPeak = flux[frame] > flux[neighbour];
+			else if (neighbour > frame) isPeak = flux[frame] >= flux[neighbour];
+		}
+		if (!isPeak) continue;
+
+		const float peakOffset = frame + 1 < numFrames ? ParabolicPeakOffset(flux[frame - 1], flux[frame], flux[frame + 1]) : 0.0f;
+		onsets.Add({ (frame + peakOffset) / frameRate + timeOffset, flux[frame], fluxBand[frame] });
+		lastOnset = frame;
+	}
+}
+
+void FBeatMap::TrackBeats(const TArray<float>& flux, const TArray<int32>& fluxBand, float frameRate, float timeOffset)
+{
+	const int32 numFrames = flux.Num();
+	const int32 minimumLag = FMath::Max(1, FMath::FloorToInt(60.0f * frameRate / MaximumTempo));
+	const int32 maximumLag = FMath::Min(numFrames - 2, FMath::CeilToInt(60.0f * frameRate / MinimumTempo));
+	if (maximumLag <= minimumLag) return;
+
+	// Tempo from the flux autocorrelation, weighted by a log normal prior so half/double tempo only wins when clearly stronger
+	TArray<float> correlation;
+	correlation.SetNumZeroed(maximumLag + 2);
+	int32 bestLag = INDEX_NONE;
+	float bestScore = 0.0f;
+	for (int32 lag = minimumLag; lag <= maximumLag + 1; lag++)
+	{
+		for (int32 frame = lag; frame < numFrames; frame++) correlation[lag] += flux[frame] * flux[frame - lag];
+
+		const float lagTempo = 60.0f * frameRate / lag;
+		const float octaves = FMath::Log2(lagTempo / PreferredTempo) / TempoPriorSpread;
+		const float score = correlation[lag] * FMath::Exp(-0.5f * octaves * octaves);
+		if (lag <= maximumLag && score > bestScore)
+		{
+			bestScore = score;
+			bestLag = lag;
+		}
+	}
+
+	if (bestLag == INDEX_NONE) return;
+
+	const float period = bestLag + (bestLag > minimumLag ? ParabolicPeakOffset(correlation[bestLag - 1], correlation[bestLag], correlation[bestLag + 1]) : 0.0f);
+	tempo = 60.0f * frameRate / period;
+
+	// Each frame's best score as a beat is its own flux plus the best earlier beat, less a penalty for straying from the period
+	TArray<float> beatScore;
+	TArray<int32> previousBeat;
+	beatScore.SetNumUninitialized(numFrames);
+	previousBeat.SetNumUninitialized(numFrames);
+	for (int32 frame = 0; frame < numFrames; frame++)
+	{
+		const int32 searchStart = FMath::Max(0, frame - FMath::RoundToInt(2.0f * period));
+		const int32 searchEnd = frame - FMath::Max(1, FMath::RoundToInt(0.5f * period));
+
+		float bestPrevious = 0.0f;
+		previousBeat[frame] = INDEX_NONE;
+		for (int32 candidate = searchStart; candidate <= searchEnd; candidate++)
+		{
+			const float deviation = FMath::Loge((frame - candidate) / period);
+			const float candidateScore = beatScore[candidate] - BeatTightness * deviation * deviation;
+			if (candidateScore > bestPrevious)
+			{
+				bestPrevious = candidateScore;
+				previousBeat[frame] = candidate;
+			}
+		}
+
+		beatScore[frame] = flux[frame] + bestPrevious;
+	}
+
+	// The chain ends on the best scoring frame in the last period and is walked back from there
+	int32 beatFrame = numFrames - 1;
+	for (int32 frame = FMath::Max(0, numFrames - FMath::CeilToInt(period)); frame < numFrames; frame++)
+	{
+		if (beatScore[frame] > beatScore[beatFrame]) beatFrame = frame;
+	}
+
+	for (; beatFrame != INDEX_NONE; beatFrame = previousBeat[beatFrame])
+	{
+		beats.Add({ beatFrame / frameRate + timeOffset, flux[beatFrame], fluxBand[beatFrame] });
+	}
+	Algo::Reverse(beats);
+}
+
+void FBeatMap::Seek(float songTime)
+{
+	nextOnset = Algo::LowerBoundBy(onsets, songTime, &GetMusicEventTime);
+	nextBeat = Algo::LowerBoundBy(beats, songTime, &GetMusicEventTime);
+	cursorTime = songTime;
+}
+
+void FBeatMap::Advance(float songTime, TFunctionRef<void(EMusicEventType eventType, const FMusicEvent& musicEvent)> onEvent)
+{
+	// A backwards jump (seek or restart) only moves the cursor, nothing fires until time moves forward again
+	if (songTime < cursorTime)
+	{
+		Seek(songTime);
+		return;
+	}
+
+	while (nextOnset < onsets.Num() && onsets[nextOnset].time <= songTime) onEvent(EMusicEventType::Onset, onsets[nextOnset++]);
+	while (nextBeat < beats.Num() && beats[nextBeat].time <= songTime) onEvent(EMusicEventType::Beat, beats[nextBeat++]);
+	cursorTime = songTime;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FSpectrogram;
+
+enum class EMusicEventType : uint8
+{
+	Onset,
+	Beat
+};
+
+struct FMusicEvent
+{
+	float time;
+	float strength;
+	int32 band;
+};
+
+/**
+ * Onset and beat timeline of a whole track, detected once at arm time from a spectrogram.
+ * Onsets are peaks in the spectral flux, beats come from a tempo estimate plus dynamic programming beat tracking.
+ * Playback walks a cursor through both sorted lists, so firing events costs nothing when there are none due.
+ */
+struct SYNTHVISUALIZER_API FBeatMap
+{
+public:
+	TArray<FMusicEvent> onsets;
+	TArray<FMusicEvent> beats;
+	float tempo;
+
+	FBeatMap();
+
+	void Reset();
+	void Build(const FSpectrogram& spectrogram, float timeSlice);
+	bool HasEvents() const { return onsets.Num() > 0 || beats.Num() > 0; }
+
+	// Playback cursor
+	void Seek(float songTime);
+	void Advance(float songTime, TFunctionRef<void(EMusicEventType eventType, const FMusicEvent& musicEvent)> onEvent);
+
+private:
+	void DetectOnsets(const TArray<float>& flux, const TArray<int32>& fluxBand, float frameRate, float timeOffset);
+	void TrackBeats(const TArray<float>& flux, const TArray<int32>& fluxBand, float frameRate, float timeOffset);
+
+private:
+	int32 nextOnset;
+	int32 nextBeat;
+	float cursorTime;
+};
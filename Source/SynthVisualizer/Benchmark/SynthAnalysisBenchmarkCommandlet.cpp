@@ -0,0 +1,314 @@
+#include "SynthAnalysisBenchmarkCommandlet.h"
+#include "Sound/SoundWave.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformMemory.h"
+#include "SynthVisualizer/Benchmark/SynthCountingMalloc.h"
+#include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+
+namespace
+{
+	// Live tracks are updated once per rendered frame, the benchmark walks the song at the same rate
+	constexpr float BenchmarkFrameRate = 60.0f;
+	constexpr int32 BenchmarkBarCount = 64;
+	constexpr int32 DefaultBenchmarkFrames = 2000;
+	constexpr float DefaultBaselineTolerance = 0.25f;
+	// Allocations per frame a baseline row may grow by before it counts as a regression
+	constexpr double BaselineAllocationSlack = 0.01;
+
+	template<typename ValueType>
+	TArray<ValueType> ParseList(const FString& Params, const TCHAR* key, const TCHAR* defaultList)
+	{
+		FString list = defaultList;
+		FParse::Value(*Params, key, list, false);
+
+		TArray<FString> entries;
+		list.ParseIntoArray(entries, TEXT(","), true);
+
+		TArray<ValueType> values;
+		for (const FString& entry : entries)
+		{
+			ValueType value;
+			LexFromString(value, *entry);
+			if (value > 0) values.Add(value);
+		}
+		return values;
+	}
+
+	FSpectrumBandLayout ParseBandLayout(const FString& Params)
+	{
+		FSpectrumBandLayout bandLayout;
+		FString bandScaleName;
+		if (FParse::Value(*Params, TEXT("BandScale="), bandScaleName))
+		{
+			const int64 bandScale = StaticEnum<ESpectrumBandScale>()->GetValueByNameString(bandScaleName);
+			if (bandScale != INDEX_NONE) bandLayout.scale = (ESpectrumBandScale)bandScale;
+		}
+		return bandLayout;
+	}
+
+	double CyclesToNanoseconds(uint64 cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(cycles) * 1.0e6;
+	}
+
+	// What the controller's activation does for its armed tracks, for tracks run without one
+	void BindStandaloneTrack(FTrackData& track, FSpectrumArena& arena)
+	{
+		arena.Reset();
+		track.ReserveSpectrumBuffers(arena);
+		arena.Allocate();
+		track.BindSpectrumBuffers(arena);
+	}
+}
+
+USynthAnalysisBenchmarkCommandlet::USynthAnalysisBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	HelpDescription = TEXT("Benchmarks synth visualizer spectrum analysis on a wave and writes the results as CSV or JSON.");
+	HelpUsage = TEXT("-run=SynthAnalysisBenchmark -File=<wav>|-Wave=<asset> [-Resolutions=32,64,256] [-TimeSlices=0.05,0.1] [-Frames=2000] [-BandScale=Linear] [-Output=<path>] [-Baseline=<csv> [-Tolerance=0.25]]");
+}
+
+int32 USynthAnalysisBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString sourceName;
+	FDecodedPCMPtr pcm = LoadPCM(Params, sourceName);
+	if (!pcm.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: Couldn't load a wave. Pass -File=<16 bit wav> or -Wave=<sound wave asset path>."));
+		return 1;
+	}
+
+	const TArray<int32> resolutions = ParseList<int32>(Params, TEXT("Resolutions="), TEXT("32,64,256,1024"));
+	const TArray<float> timeSlices = ParseList<float>(Params, TEXT("TimeSlices="), TEXT("0.05,0.1"));
+	int32 numFrames = DefaultBenchmarkFrames;
+	FParse::Value(*Params, TEXT("Frames="), numFrames);
+	numFrames = FMath::Max(1, numFrames);
+
+	const FSpectrumBandLayout bandLayout = ParseBandLayout(Params);
+
+	FString outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / TEXT("SynthAnalysisBenchmark.csv");
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	UE_LOG(LogTemp, Display, TEXT("Synth Analysis Benchmark: (%s), %d samples at %d Hz, %d frames per configuration."), *sourceName, pcm->numSamples, pcm->sampleRate, numFrames);
+
+	FSynthCountingMalloc* countingMalloc = FSynthCountingMalloc::Install();
+	TArray<FBenchmarkResult> results;
+	for (float timeSlice : timeSlices)
+	{
+		for (int32 resolution : resolutions)
+		{
+			const FBenchmarkResult& result = results.Add_GetRef(RunBenchmark(pcm, resolution, timeSlice, bandLayout, numFrames, countingMalloc));
+			UE_LOG(LogTemp, Display, TEXT("Synth Analysis Benchmark: res %4d slice %.3f | %9.1f frames/s | analyze %8.0f ns normalize %6.0f ns lookup %6.0f ns | %.2f allocs/frame | bake %9.1f frames/s"),
+				resolution, timeSlice, result.framesPerSecond, result.analyzeNanoseconds, result.normalizeNanoseconds, result.lookupNanoseconds, result.allocationsPerFrame, result.bakeFramesPerSecond);
+		}
+	}
+	countingMalloc->Uninstall();
+
+	const bool writeJSON = FPaths::GetExtension(outputPath).Equals(TEXT("json"), ESearchCase::IgnoreCase);
+	if (!FFileHelper::SaveStringToFile(writeJSON ? ToJSON(sourceName, results) : ToCSV(sourceName, results), *outputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: Couldn't write results to (%s)."), *outputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Synth Analysis Benchmark: Wrote results to (%s)."), *outputPath);
+
+	FString baselinePath;
+	if (FParse::Value(*Params, TEXT("Baseline="), baselinePath))
+	{
+		float tolerance = DefaultBaselineTolerance;
+		FParse::Value(*Params, TEXT("Tolerance="), tolerance);
+		return CompareToBaseline(baselinePath, tolerance, results) ? 0 : 1;
+	}
+	return 0;
+}
+
+FDecodedPCMPtr USynthAnalysisBenchmarkCommandlet::LoadPCM(const FString& Params, FString& outSourceName) const
+{
+	FString filePath;
+	if (FParse::Value(*Params, TEXT("File="), filePath))
+	{
+		TArray<uint8> waveFile;
+		if (!FFileHelper::LoadFileToArray(waveFile, *filePath)) return nullptr;
+
+		outSourceName = FPaths::GetCleanFilename(filePath);
+		return FSynthPCMCache::DecodeWaveFile(waveFile.GetData(), waveFile.Num());
+	}
+
+	FString wavePath;
+	if (FParse::Value(*Params, TEXT("Wave="), wavePath))
+	{
+		USoundWave* soundWave = LoadObject<USoundWave>(nullptr, *wavePath);
+		if (soundWave == nullptr) return nullptr;
+
+		outSourceName = soundWave->GetName();
+		return FSynthPCMCache::Get().Acquire(soundWave);
+	}
+
+	return nullptr;
+}
+
+USynthAnalysisBenchmarkCommandlet::FBenchmarkResult USynthAnalysisBenchmarkCommandlet::RunBenchmark(const FDecodedPCMPtr& pcm, int32 spectrumResolution, float spectrumTimeSlice, const FSpectrumBandLayout& bandLayout, int32 numFrames, FSynthCountingMalloc* countingMalloc) const
+{
+	FBenchmarkResult result;
+	result.spectrumResolution = spectrumResolution;
+	result.spectrumTimeSlice = spectrumTimeSlice;
+	result.numFrames = numFrames;
+
+	// Set the track up the way ArmTrack does for a live, game thread analyzed track
+	FTrackData track;
+	track.spectrumResolution = spectrumResolution;
+	track.spectrumTimeSlice = spectrumTimeSlice;
+	track.bandLayout = bandLayout;
+	track.pcm = pcm;
+	track.analyzer.SetBandLayout(bandLayout);
+	track.isArmed = true;
+	FSpectrumArena arena;
+	BindStandaloneTrack(track, arena);
+
+	TArray<float> barValues;
+	barValues.SetNumUninitialized(BenchmarkBarCount);
+
+	// FFT tables and the band matrix are built outside the measured loop, as activation builds them
+	track.PrepareAnalyzer();
+
+	const float duration = FMath::Max(pcm->GetDuration(), 1.0f / BenchmarkFrameRate);
+	uint64 analyzeCycles = 0;
+	uint64 normalizeCycles = 0;
+	uint64 lookupCycles = 0;
+	// The frame loop runs on this thread only, so other threads' allocations stay out of the count
+	const FSynthCountingMalloc::FCounts countsBefore = countingMalloc->GetThreadCounts();
+	for (int32 frame = 0; frame < numFrames; frame++)
+	{
+		const float songTime = FMath::Fmod(frame / BenchmarkFrameRate, duration);
+
+		const uint64 analyzeStart = FPlatformTime::Cycles64();
+		track.analyzer.CalculateFrequencySpectrum(*pcm, songTime, spectrumTimeSlice, spectrumResolution, track.spectrumWindow, track.spectrum);
+		const uint64 normalizeStart = FPlatformTime::Cycles64();
+		track.BuildNormalizedSpectrum();
+		const uint64 lookupStart = FPlatformTime::Cycles64();
+		track.EvaluateNormalizedBars(BenchmarkBarCount, barValues.GetData());
+		const uint64 frameEnd = FPlatformTime::Cycles64();
+
+		analyzeCycles += normalizeStart - analyzeStart;
+		normalizeCycles += lookupStart - normalizeStart;
+		lookupCycles += frameEnd - lookupStart;
+	}
+	const FSynthCountingMalloc::FCounts countsAfter = countingMalloc->GetThreadCounts();
+
+	result.analyzeNanoseconds = CyclesToNanoseconds(analyzeCycles) / numFrames;
+	result.normalizeNanoseconds = CyclesToNanoseconds(normalizeCycles) / numFrames;
+	result.lookupNanoseconds = CyclesToNanoseconds(lookupCycles) / numFrames;
+	const double frameNanoseconds = result.analyzeNanoseconds + result.normalizeNanoseconds + result.lookupNanoseconds;
+	result.framesPerSecond = frameNanoseconds > 0.0 ? 1.0e9 / frameNanoseconds : 0.0;
+	result.allocationsPerFrame = (double)(countsAfter.allocations - countsBefore.allocations) / numFrames;
+
+	// Whole track bake, the path bakeSpectrum and spectrogram assets take
+	FSpectrogram spectrogram;
+	const FSynthCountingMalloc::FCounts bakeCountsBefore = countingMalloc->GetCounts();
+	const uint64 bakeStart = FPlatformTime::Cycles64();
+	FSpectrogram::Bake(*pcm, spectrumTimeSlice, spectrumResolution, track.spectrumWindow, bandLayout, BenchmarkFrameRate, spectrogram);
+	const double bakeSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - bakeStart);
+	result.bakeAllocations = countingMalloc->GetCounts().allocations - bakeCountsBefore.allocations;
+	result.bakeFramesPerSecond = bakeSeconds > 0.0 ? spectrogram.numFrames / bakeSeconds : 0.0;
+
+	result.peakUsedMB = FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0);
+	return result;
+}
+
+FString USynthAnalysisBenchmarkCommandlet::ToCSV(const FString& sourceName, const TArray<FBenchmarkResult>& results) const
+{
+	FString csv = TEXT("source,resolution,timeSlice,frames,framesPerSecond,analyzeNsPerFrame,normalizeNsPerFrame,lookupNsPerFrame,allocationsPerFrame,bakeFramesPerSecond,bakeAllocations,peakUsedMB\n");
+	for (const FBenchmarkResult& result : results)
+	{
+		csv += FString::Printf(TEXT("%s,%d,%.4f,%d,%.1f,%.1f,%.1f,%.1f,%.3f,%.1f,%llu,%.1f\n"),
+			*sourceName, result.spectrumResolution, result.spectrumTimeSlice, result.numFrames, result.framesPerSecond,
+			result.analyzeNanoseconds, result.normalizeNanoseconds, result.lookupNanoseconds, result.allocationsPerFrame,
+			result.bakeFramesPerSecond, result.bakeAllocations, result.peakUsedMB);
+	}
+	return csv;
+}
+
+FString USynthAnalysisBenchmarkCommandlet::ToJSON(const FString& sourceName, const TArray<FBenchmarkResult>& results) const
+{
+	FString json = FString::Printf(TEXT("{\n\t\"source\": \"%s\",\n\t\"results\": [\n"), *sourceName.ReplaceCharWithEscapedChar());
+	for (int i = 0; i < results.Num(); i++)
+	{
+		const FBenchmarkResult& result = results[i];
+		json += FString::Printf(TEXT("\t\t{ \"resolution\": %d, \"timeSlice\": %.4f, \"frames\": %d, \"framesPerSecond\": %.1f, \"analyzeNsPerFrame\": %.1f, \"normalizeNsPerFrame\": %.1f, \"lookupNsPerFrame\": %.1f, \"allocationsPerFrame\": %.3f, \"bakeFramesPerSecond\": %.1f, \"bakeAllocations\": %llu, \"peakUsedMB\": %.1f }%s\n"),
+			result.spectrumResolution, result.spectrumTimeSlice, result.numFrames, result.framesPerSecond,
+			result.analyzeNanoseconds, result.normalizeNanoseconds, result.lookupNanoseconds, result.allocationsPerFrame,
+			result.bakeFramesPerSecond, result.bakeAllocations, result.peakUsedMB, i + 1 < results.Num() ? TEXT(",") : TEXT(""));
+	}
+	json += TEXT("\t]\n}\n");
+	return json;
+}
+
+bool USynthAnalysisBenchmarkCommandlet::CompareToBaseline(const FString& baselinePath, float tolerance, const TArray<FBenchmarkResult>& results) const
+{
+	TArray<FString> lines;
+	if (!FFileHelper::LoadFileToStringArray(lines, *baselinePath) || lines.Num() < 2)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: Couldn't read a baseline from (%s)."), *baselinePath);
+		return false;
+	}
+
+	// Columns are looked up by name so older baselines keep working as columns are added
+	TArray<FString> header;
+	lines[0].ParseIntoArray(header, TEXT(","), false);
+	const int32 resolutionColumn = header.IndexOfByKey(TEXT("resolution"));
+	const int32 timeSliceColumn = header.IndexOfByKey(TEXT("timeSlice"));
+	const int32 analyzeColumn = header.IndexOfByKey(TEXT("analyzeNsPerFrame"));
+	const int32 normalizeColumn = header.IndexOfByKey(TEXT("normalizeNsPerFrame"));
+	const int32 lookupColumn = header.IndexOfByKey(TEXT("lookupNsPerFrame"));
+	const int32 allocationsColumn = header.IndexOfByKey(TEXT("allocationsPerFrame"));
+	if (resolutionColumn == INDEX_NONE || timeSliceColumn == INDEX_NONE || analyzeColumn == INDEX_NONE || normalizeColumn == INDEX_NONE || lookupColumn == INDEX_NONE || allocationsColumn == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: (%s) isn't a benchmark CSV."), *baselinePath);
+		return false;
+	}
+
+	// Only configurations in both runs are compared, the baseline should be recorded with the same wave
+	bool passed = true;
+	int32 numCompared = 0;
+	for (int32 line = 1; line < lines.Num(); line++)
+	{
+		TArray<FString> columns;
+		if (lines[line].ParseIntoArray(columns, TEXT(","), false) < header.Num()) continue;
+
+		const int32 resolution = FCString::Atoi(*columns[resolutionColumn]);
+		const float timeSlice = FCString::Atof(*columns[timeSliceColumn]);
+		const FBenchmarkResult* result = results.FindByPredicate([resolution, timeSlice](const FBenchmarkResult& candidate)
+		{
+			return candidate.spectrumResolution == resolution && FMath::IsNearlyEqual(candidate.spectrumTimeSlice, timeSlice, 1.0e-4f);
+		});
+		if (result == nullptr) continue;
+
+		// Blank timing columns gate allocations only, timings from another machine mean nothing here
+		const bool hasTimings = !columns[analyzeColumn].IsEmpty() && !columns[normalizeColumn].IsEmpty() && !columns[lookupColumn].IsEmpty();
+		const double baselineNanoseconds = FCString::Atod(*columns[analyzeColumn]) + FCString::Atod(*columns[normalizeColumn]) + FCString::Atod(*columns[lookupColumn]);
+		const double baselineAllocations = FCString::Atod(*columns[allocationsColumn]);
+		const double frameNanoseconds = result->analyzeNanoseconds + result->normalizeNanoseconds + result->lookupNanoseconds;
+		numCompared++;
+		if ((hasTimings && frameNanoseconds > baselineNanoseconds * (1.0 + tolerance)) || result->allocationsPerFrame > baselineAllocations + BaselineAllocationSlack)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: res %d slice %.3f regressed, %.0f ns/frame and %.2f allocs/frame against a baseline of %.0f ns/frame and %.2f allocs/frame."),
+				resolution, timeSlice, frameNanoseconds, result->allocationsPerFrame, baselineNanoseconds, baselineAllocations);
+			passed = false;
+		}
+	}
+
+	if (numCompared == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Synth Analysis Benchmark: (%s) has none of the benchmarked configurations."), *baselinePath);
+		return false;
+	}
+
+	if (passed) UE_LOG(LogTemp, Display, TEXT("Synth Analysis Benchmark: %d configuration(s) within %.0f%% of the baseline."), numCompared, tolerance * 100.0f);
+	return passed;
+}
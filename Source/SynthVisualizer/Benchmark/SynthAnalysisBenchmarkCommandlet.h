@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumBandLayout.h"
+#include "SynthAnalysisBenchmarkCommandlet.generated.h"
+
+class FSynthCountingMalloc;
+
+/**
+ * Headless analysis benchmark, runs a wave through the same analyzer/normalize/lookup path a live track uses.
+ * UE4Editor-Cmd <Project> -run=SynthAnalysisBenchmark -File=<wav>|-Wave=<asset path> [-Resolutions=32,64,256]
+ *     [-TimeSlices=0.05,0.1] [-Frames=2000] [-BandScale=Linear] [-Output=<path.csv|path.json>] -nullrhi -nosound
+ *
+ * Given -Baseline=<csv from an earlier run> it fails if ns/frame grew by more than -Tolerance (default 0.25)
+ * or allocations per frame grew at all. Correctness checks live in the SynthVisualizer automation tests.
+ *
+ * Build/Benchmark/SynthAnalysisBaseline.csv is the checked in baseline for the default configurations. It pins
+ * allocations per frame at zero and leaves the timing columns blank, which skips the ns/frame check, since timings
+ * only compare on the machine that recorded them. To gate timings, record an -Output CSV on the benchmark machine
+ * and pass that as the baseline for later runs there.
+ */
+UCLASS()
+class SYNTHVISUALIZER_API USynthAnalysisBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USynthAnalysisBenchmarkCommandlet();
+
+	// Commandlet
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FBenchmarkResult
+	{
+		int32 spectrumResolution;
+		float spectrumTimeSlice;
+		int32 numFrames;
+		double analyzeNanoseconds;
+		double normalizeNanoseconds;
+		double lookupNanoseconds;
+		double framesPerSecond;
+		double allocationsPerFrame;
+		double bakeFramesPerSecond;
+		uint64 bakeAllocations;
+		double peakUsedMB;
+	};
+
+	FDecodedPCMPtr LoadPCM(const FString& Params, FString& outSourceName) const;
+	FBenchmarkResult RunBenchmark(const FDecodedPCMPtr& pcm, int32 spectrumResolution, float spectrumTimeSlice, const FSpectrumBandLayout& bandLayout, int32 numFrames, FSynthCountingMalloc* countingMalloc) const;
+	FString ToCSV(const FString& sourceName, const TArray<FBenchmarkResult>& results) const;
+	FString ToJSON(const FString& sourceName, const TArray<FBenchmarkResult>& results) const;
+	bool CompareToBaseline(const FString& baselinePath, float tolerance, const TArray<FBenchmarkResult>& results) const;
+};
@@ -0,0 +1,76 @@
+#include "SynthCountingMalloc.h"
+
+namespace
+{
+	// Plain thread_local rather than a TLS slot, reading one must never allocate
+	thread_local FSynthCountingMalloc::FCounts ThreadCounts = { 0, 0, 0 };
+}
+
+FSynthCountingMalloc* FSynthCountingMalloc::Install()
+{
+	static FSynthCountingMalloc* countingMalloc = nullptr;
+	if (countingMalloc == nullptr) countingMalloc = new FSynthCountingMalloc(GMalloc);
+	if (GMalloc != countingMalloc)
+	{
+		// Publish the inner allocator before the proxy, a thread that picks up the new GMalloc must see where to forward
+		countingMalloc->innerMalloc = GMalloc;
+		FPlatformMisc::MemoryBarrier();
+		GMalloc = countingMalloc;
+		FPlatformMisc::MemoryBarrier();
+	}
+	return countingMalloc;
+}
+
+void FSynthCountingMalloc::Uninstall()
+{
+	// Calls already inside the proxy keep forwarding to the same inner allocator, so they finish safely
+	if (GMalloc == this) GMalloc = innerMalloc;
+	FPlatformMisc::MemoryBarrier();
+}
+
+FSynthCountingMalloc::FCounts FSynthCountingMalloc::GetCounts() const
+{
+	return { allocations.load(), frees.load(), bytesRequested.load() };
+}
+
+FSynthCountingMalloc::FCounts FSynthCountingMalloc::GetThreadCounts() const
+{
+	return ThreadCounts;
+}
+
+void* FSynthCountingMalloc::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	allocations++;
+	bytesRequested += Count;
+	ThreadCounts.allocations++;
+	ThreadCounts.bytesRequested += Count;
+	return innerMalloc->Malloc(Count, Alignment);
+}
+
+void* FSynthCountingMalloc::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	// A realloc can always move the block, so every resize counts as an allocation
+	if (Count > 0)
+	{
+		allocations++;
+		bytesRequested += Count;
+		ThreadCounts.allocations++;
+		ThreadCounts.bytesRequested += Count;
+	}
+	else if (Original != nullptr)
+	{
+		frees++;
+		ThreadCounts.frees++;
+	}
+	return innerMalloc->Realloc(Original, Count, Alignment);
+}
+
+void FSynthCountingMalloc::Free(void* Original)
+{
+	if (Original != nullptr)
+	{
+		frees++;
+		ThreadCounts.frees++;
+	}
+	innerMalloc->Free(Original);
+}
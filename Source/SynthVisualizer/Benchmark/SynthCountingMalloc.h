@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+#include <atomic>
+
+/**
+ * FMalloc proxy that counts calls before forwarding them to the allocator it wraps.
+ * Install() swaps it in as GMalloc for the duration of a benchmark. The proxy is never deleted
+ * since other threads may still be holding it after Uninstall() puts the original back.
+ * Other threads keep allocating while it's installed, GetThreadCounts() only sees the calling thread's
+ * calls so single threaded code can be held to an exact count.
+ */
+class SYNTHVISUALIZER_API FSynthCountingMalloc : public FMalloc
+{
+public:
+	struct FCounts
+	{
+		uint64 allocations;
+		uint64 frees;
+		uint64 bytesRequested;
+	};
+
+	static FSynthCountingMalloc* Install();
+	void Uninstall();
+	FCounts GetCounts() const;
+	FCounts GetThreadCounts() const;
+
+	// FMalloc
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void Free(void* Original) override;
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return innerMalloc->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return innerMalloc->GetAllocationSize(Original, SizeOut); }
+	virtual void Trim(bool bTrimThreadCaches) override { innerMalloc->Trim(bTrimThreadCaches); }
+	virtual void SetupTLSCachesOnCurrentThread() override { innerMalloc->SetupTLSCachesOnCurrentThread(); }
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override { innerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+	virtual void InitializeStatsMetadata() override { innerMalloc->InitializeStatsMetadata(); }
+	virtual void UpdateStats() override { innerMalloc->UpdateStats(); }
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { innerMalloc->GetAllocatorStats(OutStats); }
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override { innerMalloc->DumpAllocatorStats(Ar); }
+	virtual bool IsInternallyThreadSafe() const override { return innerMalloc->IsInternallyThreadSafe(); }
+	virtual bool ValidateHeap() override { return innerMalloc->ValidateHeap(); }
+	virtual const TCHAR* GetDescriptiveName() override { return TEXT("SynthCountingMalloc"); }
+
+private:
+	explicit FSynthCountingMalloc(FMalloc* inInnerMalloc) : innerMalloc(inInnerMalloc), allocations(0), frees(0), bytesRequested(0) {}
+
+	FMalloc* innerMalloc;
+	std::atomic<uint64> allocations;
+	std::atomic<uint64> frees;
+	std::atomic<uint64> bytesRequested;
+};
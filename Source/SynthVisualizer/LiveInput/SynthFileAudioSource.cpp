@@ -0,0 +1,44 @@
+#include "SynthFileAudioSource.h"
+#include "SynthVisualizer/LiveInput/SynthLiveInput.h"
+
+namespace
+{
+	// A hitch longer than this is dropped rather than pushed in one burst, the input only keeps the newest window anyway
+	constexpr double MaxPumpSeconds = 0.25;
+}
+
+FSynthFileAudioSource::FSynthFileAudioSource(const FDecodedPCMPtr& inPCM)
+{
+	pcm = inPCM;
+	playPosition = 0;
+	lastPumpTime = 0.0;
+	check(!pcm.IsValid() || pcm->format == ESynthPCMFormat::Float);
+}
+
+void FSynthFileAudioSource::PumpFrames(FSynthLiveInput& input, int32 numFrames)
+{
+	if (!pcm.IsValid() || pcm->numSamples <= 0) return;
+
+	const float* samples = pcm->GetFloatData();
+	while (numFrames > 0)
+	{
+		const int32 run = FMath::Min(numFrames, pcm->numSamples - playPosition);
+		input.PushSamples(samples + playPosition, run, 1);
+		playPosition = (playPosition + run) % pcm->numSamples;
+		numFrames -= run;
+	}
+}
+
+void FSynthFileAudioSource::PumpRealtime(FSynthLiveInput& input)
+{
+	const double now = FPlatformTime::Seconds();
+	if (lastPumpTime <= 0.0) lastPumpTime = now;
+
+	const double elapsed = FMath::Min(now - lastPumpTime, MaxPumpSeconds);
+	const int32 numFrames = (int32)(elapsed * GetSampleRate());
+	if (numFrames <= 0) return;
+
+	// Advance by whole samples only, so the fraction carries over to the next pump
+	lastPumpTime += (double)numFrames / GetSampleRate() + FMath::Max(0.0, now - lastPumpTime - MaxPumpSeconds);
+	PumpFrames(input, numFrames);
+}
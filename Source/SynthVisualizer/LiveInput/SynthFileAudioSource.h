@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+
+class FSynthLiveInput;
+
+/**
+ * Stands in for the audio device when there isn't one (headless runs, -nosound), playing decoded PCM into a
+ * FSynthLiveInput at real time, looping. Only the producer side changes, analysis reads the input the same way.
+ */
+class SYNTHVISUALIZER_API FSynthFileAudioSource
+{
+public:
+	// Float PCM only
+	explicit FSynthFileAudioSource(const FDecodedPCMPtr& inPCM);
+
+	// Pushes the next numFrames samples, wrapping at the end of the track
+	void PumpFrames(FSynthLiveInput& input, int32 numFrames);
+	// Pushes however many samples have played since the last pump
+	void PumpRealtime(FSynthLiveInput& input);
+
+	FORCEINLINE int32 GetSampleRate() const { return pcm.IsValid() ? pcm->sampleRate : 0; }
+
+private:
+	FDecodedPCMPtr pcm;
+	int32 playPosition;
+	double lastPumpTime;
+};
@@ -0,0 +1,129 @@
+#include "SynthLiveInput.h"
+#include "AudioDeviceManager.h"
+#include "Engine/Engine.h"
+
+namespace
+{
+	// Enough ring for a few hitched game frames before the audio thread starts dropping samples
+	constexpr float RingSeconds = 0.5f;
+}
+
+constexpr int32 FSynthLiveInput::MixBlockFrames;
+
+FSynthLiveInput::FSynthLiveInput(int32 inSampleRate, float historySeconds)
+{
+	sampleRate = FMath::Max(1, inSampleRate);
+	droppedSamples = 0;
+	audioDeviceID = (Audio::FDeviceId)INDEX_NONE;
+	listeningSubmix = nullptr;
+	isListening = false;
+
+	historySize = FMath::Max(1, FMath::CeilToInt(historySeconds * sampleRate));
+	historyPosition = 0;
+	numHistory = 0;
+	history.Init(0.0f, historySize * 2);
+	ring.Reset(FMath::Max(historySize, FMath::CeilToInt(RingSeconds * sampleRate)));
+}
+
+FSynthLiveInput::~FSynthLiveInput()
+{
+	StopListening();
+}
+
+bool FSynthLiveInput::ListenToSubmix(USoundSubmix* submix)
+{
+	StopListening();
+
+	FAudioDevice* audioDevice = GEngine ? GEngine->GetMainAudioDeviceRaw() : nullptr;
+	if (audioDevice == nullptr) return false;
+
+	sampleRate = FMath::Max(1, (int32)audioDevice->GetSampleRate());
+	audioDevice->RegisterSubmixBufferListener(this, submix);
+	audioDeviceID = audioDevice->DeviceID;
+	listeningSubmix = submix;
+	isListening = true;
+	return true;
+}
+
+void FSynthLiveInput::StopListening()
+{
+	if (!isListening) return;
+	isListening = false;
+
+	FAudioDeviceManager* deviceManager = GEngine ? GEngine->GetAudioDeviceManager() : nullptr;
+	FAudioDevice* audioDevice = deviceManager ? deviceManager->GetAudioDeviceRaw(audioDeviceID) : nullptr;
+	if (audioDevice != nullptr)
+	{
+		// Unregistering is queued to the audio thread, flush so no callback can land on a destroyed listener
+		audioDevice->UnregisterSubmixBufferListener(this, listeningSubmix);
+		audioDevice->FlushAudioRenderingCommands();
+	}
+	listeningSubmix = nullptr;
+}
+
+void FSynthLiveInput::PushSamples(const float* interleavedSamples, int32 numFrames, int32 numChannels)
+{
+	if (interleavedSamples == nullptr || numFrames <= 0 || numChannels <= 0) return;
+
+	int32 written = 0;
+	if (numChannels == 1)
+	{
+		written = ring.Write(interleavedSamples, numFrames);
+	}
+	else
+	{
+		const float channelScale = 1.0f / numChannels;
+		for (int32 blockStart = 0; blockStart < numFrames; blockStart += MixBlockFrames)
+		{
+			const int32 blockFrames = FMath::Min(MixBlockFrames, numFrames - blockStart);
+			const float* blockSamples = interleavedSamples + blockStart * numChannels;
+			for (int32 i = 0; i < blockFrames; i++)
+			{
+				float frameSum = 0.0f;
+				for (int32 channel = 0; channel < numChannels; channel++) frameSum += blockSamples[i * numChannels + channel];
+				mixBlock[i] = frameSum * channelScale;
+			}
+			written += ring.Write(mixBlock, blockFrames);
+		}
+	}
+
+	if (written < numFrames) droppedSamples += numFrames - written;
+}
+
+int32 FSynthLiveInput::Update()
+{
+	// Only the newest historySize samples can ever be read, anything older is skipped rather than copied
+	ring.Skip(historySize);
+
+	int32 numNewSamples = 0;
+	for (;;)
+	{
+		float* target = history.GetData() + historyPosition;
+		const int32 run = ring.Read(target, historySize - historyPosition);
+		if (run == 0) break;
+
+		FMemory::Memcpy(target + historySize, target, run * sizeof(float));
+		historyPosition = (historyPosition + run) % historySize;
+		numNewSamples += run;
+	}
+
+	numHistory = FMath::Min(historySize, numHistory + numNewSamples);
+	return numNewSamples;
+}
+
+const float* FSynthLiveInput::GetHistory(int32& outNumSamples) const
+{
+	outNumSamples = numHistory;
+	return history.GetData() + historyPosition + historySize - numHistory;
+}
+
+SIZE_T FSynthLiveInput::GetAllocatedSize() const
+{
+	return history.GetAllocatedSize() + ring.GetCapacity() * sizeof(float);
+}
+
+void FSynthLiveInput::OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock)
+{
+	sampleRate.store(SampleRate, std::memory_order_relaxed);
+	PushSamples(AudioData, NumChannels > 0 ? NumSamples / NumChannels : 0, NumChannels);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioDevice.h"
+#include "SynthDSP/SpscRing.h"
+#include <atomic>
+
+class USoundSubmix;
+
+/**
+ * Live mono audio for analysis, fed from a submix on the audio render thread (line-in, DJ sets routed through the mixer)
+ * or by FSynthFileAudioSource when there's no device. Samples cross threads through a lock free SPSC ring,
+ * the producer side never locks or allocates. The consumer drains the ring into a mirrored history so the newest
+ * window is always contiguous and can go straight to FSpectrumAnalyzer.
+ */
+class SYNTHVISUALIZER_API FSynthLiveInput : public ISubmixBufferListener
+{
+public:
+	FSynthLiveInput(int32 inSampleRate, float historySeconds);
+	virtual ~FSynthLiveInput();
+
+	// Game thread. Listens to a submix on the main audio device, nullptr for the master submix
+	bool ListenToSubmix(USoundSubmix* submix);
+	void StopListening();
+
+	// Producer, whichever single thread feeds the input. Mixes down to mono, drops what doesn't fit in the ring
+	void PushSamples(const float* interleavedSamples, int32 numFrames, int32 numChannels);
+
+	// Consumer. Drains the ring into the history, returns the number of new samples
+	int32 Update();
+	// Consumer. The newest samples, oldest first, contiguous
+	const float* GetHistory(int32& outNumSamples) const;
+
+	FORCEINLINE int32 GetSampleRate() const { return sampleRate; }
+	FORCEINLINE uint32 GetDroppedSamples() const { return droppedSamples; }
+	SIZE_T GetAllocatedSize() const;
+
+	// ISubmixBufferListener
+	virtual void OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock) override;
+
+private:
+	SynthDSP::FSpscRing ring;
+
+	// Consumer only. Every sample is written twice, historySize apart, so any window up to historySize is contiguous
+	TArray<float> history;
+	int32 historySize;
+	int32 historyPosition;
+	int32 numHistory;
+
+	// Producer only, mono mixdown in blocks so a buffer of any size goes through without allocating
+	static constexpr int32 MixBlockFrames = 256;
+	float mixBlock[MixBlockFrames];
+
+	std::atomic<int32> sampleRate;
+	std::atomic<uint32> droppedSamples;
+
+	Audio::FDeviceId audioDeviceID;
+	USoundSubmix* listeningSubmix;
+	bool isListening;
+};
+
+typedef TSharedPtr<FSynthLiveInput, ESPMode::ThreadSafe> FSynthLiveInputPtr;
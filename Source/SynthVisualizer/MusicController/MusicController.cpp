@@ -2,12 +2,51 @@
 
 
 #include "MusicController.h"
+#include "SynthVisualizer/SynthVisualizer.h"
+#include "SynthVisualizer/Spectrogram/SynthSpectrogramAsset.h"
+#include "SynthVisualizer/MusicResponder/MusicResponder.h"
+#include "SynthVisualizer/MusicSubsystem/SynthMusicSubsystem.h"
+#include "SynthVisualizer/LiveInput/SynthFileAudioSource.h"
 #include "Components/AudioComponent.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "HAL/MemoryBase.h"
+#include "Async/ParallelFor.h"
+#include "AudioDevice.h"
+#include "Engine/Engine.h"
+#include "Sound/SoundSubmix.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Async/Async.h"
+#include "SynthDSP/SpectrumMath.h"
+#include "SynthDSP/Envelope.h"
 
 #include "DrawDebugHelpers.h"
 
+namespace
+{
+	// 10ms hop, fine enough for onsets and only paid once at arm time
+	constexpr float BeatDetectionFrameRate = 100.0f;
+
+	// Playback clock drift under the snap threshold is smoothed out over the correction time, anything larger is a seek
+	constexpr float ClockSnapThreshold = 0.25f;
+	constexpr float ClockDriftCorrectionTime = 0.5f;
+
+	// Live input keeps twice the slice so the power of two frame always fits
+	constexpr float LiveHistorySlices = 2.0f;
+
+	// Audio finishing this far before the song's duration is reported as cut short
+	constexpr float SongEndTolerance = 1.0f;
+
+	// Raw, normalized, envelope, peak and peak hold timers
+	constexpr int32 SpectrumBufferCount = 5;
+
+	FORCEINLINE void CountSpectrumQueries(int32 count)
+	{
+		INC_DWORD_STAT_BY(STAT_SynthSpectrumQueries, count);
+		CSV_CUSTOM_STAT(SynthVisualizer, SpectrumQueries, count, ECsvCustomStatOp::Accumulate);
+	}
+}
+
 FTrackData::FTrackData()
 {
 	trackID = FName("TrackID");
@@ -16,26 +55,148 @@ FTrackData::FTrackData()
 	spectrumTimeSlice = 0.1f;
 	spectrumClamp = 60.0f;
 	spectrumPowerFactor = 2.0f;
+	spectrumWindow = ESpectrumWindowType::Hann;
+	bakeSpectrum = false;
+	bakeFrameRate = 60.0f;
+	bakeFormat = ESynthSpectrogramFormat::Float;
+	spectrogramAsset = nullptr;
+	pcmFormat = ESynthPCMFormat::Float;
+	streamAnalysis = false;
+	analyzeLiveInput = false;
+	liveSubmix = nullptr;
+	detectBeats = false;
+	envelopeAttackTime = 0.01f;
+	envelopeReleaseTime = 0.15f;
+	peakHoldTime = 0.25f;
+	peakReleaseTime = 0.5f;
+	workerSlot = INDEX_NONE;
 	isArmed = false;
 	minFrequency = spectrumClamp;
 	maxFrequency = -spectrumClamp;
-	spectrum = TArray<float>();
 	trackInstance = nullptr;
 	trackColour = FColor::White;
-	for (int i = 0; i < spectrumResolution; i++) spectrum.Add(-spectrumClamp);
+	arenaOffset = INDEX_NONE;
 }
 
 void FTrackData::ArmTrack(AMusicController* musicController, USoundWave* masterTrack)
+{
+	if (BeginArm(musicController) && PrepareAnalysis(musicController)) FinishArm(musicController, masterTrack);
+}
+
+bool FTrackData::BeginArm(AMusicController* musicController)
 {
 	isArmed = false;
-	if (track == nullptr || !track->IsValidLowLevel()) return;
+	if (track == nullptr && !trackAsset.IsNull()) track = trackAsset.LoadSynchronous();
+	if (!analyzeLiveInput && (track == nullptr || !track->IsValidLowLevel())) return false;
 
 	trackInstance = track;
-	spectrum.Empty();
-	for (int i = 0; i < spectrumResolution; i++) spectrum.Add(-spectrumClamp);
+	pcm.Reset();
+	pcmSource.Reset();
+	pcmStream.Reset();
+	liveInput.Reset();
+	liveFileSource.Reset();
+	spectrogram.Reset();
+	analyzer.SetBandLayout(bandLayout);
+
+	if (analyzeLiveInput)
+	{
+		if (!ArmLiveInput(musicController)) return false;
+		if (bakeSpectrum || detectBeats)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Track (%s) is live, baking and beat detection are skipped."), *(musicController->GetName()), *(trackID.ToString()));
+		}
+		return true;
+	}
+
+	if (musicController->IsUsingBlueprintSpectrum() && bandLayout.scale != ESpectrumBandScale::Linear)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Track (%s) band layout is ignored while using the blueprint spectrum override."), *(musicController->GetName()), *(trackID.ToString()));
+	}
+
+	// A cooked spectrogram replaces all runtime analysis, nothing needs decoding
+	if (!musicController->IsUsingBlueprintSpectrum() && spectrogramAsset != nullptr)
+	{
+		// Editor bakes run in the background. Playlist preparation waits for them before arming, a direct arm blocks here.
+		spectrogramAsset->FinishCaching();
+		if (spectrogramAsset->MatchesTrack(trackInstance, spectrumResolution, spectrumTimeSlice, spectrumClamp, spectrumWindow, bandLayout))
+		{
+			spectrogram.SetExternalFrames(spectrogramAsset->MapFrames(), spectrogramAsset->GetNumFrames(), spectrogramAsset->spectrumResolution, spectrogramAsset->frameRate, spectrogramAsset->GetFrameFormat());
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Spectrogram asset (%s) doesn't match track (%s) settings, analyzing at runtime."), *(musicController->GetName()), *(spectrogramAsset->GetName()), *(trackID.ToString()));
+		}
+	}
+
+	const bool shouldStream = streamAnalysis || (musicController->StreamTracksLongerThan > 0.0f && trackInstance->GetDuration() > musicController->StreamTracksLongerThan);
+	if (!spectrogram.IsValid() && !musicController->IsUsingBlueprintSpectrum() && shouldStream)
+	{
+		pcmStream = FSynthPCMStream::Open(trackInstance);
+		if (!pcmStream.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to open track (%s) for streamed spectrum analysis."), *(musicController->GetName()), *(trackID.ToString()));
+			return false;
+		}
+	}
+	else if (!spectrogram.IsValid() && !musicController->IsUsingBlueprintSpectrum())
+	{
+		// Only the copy out of the wave has to happen here, the decode itself can run on any thread
+		pcmSource = FSynthPCMCache::Get().PrepareDecode(trackInstance, pcmFormat);
+		if (!pcmSource.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to read track (%s) for spectrum analysis."), *(musicController->GetName()), *(trackID.ToString()));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FTrackData::PrepareAnalysis(AMusicController* musicController)
+{
+	if (liveInput.IsValid()) return true;
+
+	if (!spectrogram.IsValid() && !pcmStream.IsValid() && !musicController->IsUsingBlueprintSpectrum())
+	{
+		pcm = pcmSource.IsValid() ? FSynthPCMCache::Get().Acquire(*pcmSource) : FDecodedPCMPtr();
+		pcmSource.Reset();
+		if (!pcm.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to decode track (%s) for spectrum analysis."), *(musicController->GetName()), *(trackID.ToString()));
+			return false;
+		}
+	}
+
+	if (bakeSpectrum && !spectrogram.IsValid())
+	{
+		if (pcmStream.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Can't bake streamed track (%s), analyzing at runtime."), *(musicController->GetName()), *(trackID.ToString()));
+		}
+		else if (musicController->IsUsingBlueprintSpectrum())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Can't bake track (%s) while using the blueprint spectrum override."), *(musicController->GetName()), *(trackID.ToString()));
+		}
+		else
+		{
+			FSpectrogram::Bake(*pcm, spectrumTimeSlice, spectrumResolution, spectrumWindow, bandLayout, bakeFrameRate, spectrogram);
+			pcm.Reset();
+			UE_LOG(LogTemp, Log, TEXT("(%s): Baked track (%s) spectrogram (%d frames)."), *(musicController->GetName()), *(trackID.ToString()), spectrogram.numFrames);
+		}
+	}
+
+	if (detectBeats) BuildBeatMap(musicController);
+	// After beat detection, so onsets are found on full precision frames
+	if (bakeFormat != ESynthSpectrogramFormat::Float) spectrogram.Compact(bakeFormat);
+
+	return true;
+}
+
+void FTrackData::FinishArm(AMusicController* musicController, USoundWave* masterTrack)
+{
 	isArmed = true;
 
-	if (masterTrack != nullptr)
+	if (masterTrack != nullptr && trackInstance != nullptr)
 	{
 		if (trackInstance->GetDuration() != masterTrack->GetDuration())
 		{
@@ -44,11 +205,86 @@ void FTrackData::ArmTrack(AMusicController* musicController, USoundWave* masterT
 	}
 }
 
+void FTrackData::DisarmTrack()
+{
+	isArmed = false;
+	workerSlot = INDEX_NONE;
+	pcm.Reset();
+	pcmSource.Reset();
+	pcmStream.Reset();
+	liveInput.Reset();
+	liveFileSource.Reset();
+	spectrogram.Reset();
+	beatMap.Reset();
+
+	// The arena goes away with the controller's disarm
+	spectrum = TArrayView<float>();
+	normalizedSpectrum = TArrayView<float>();
+	envelopeSpectrum = TArrayView<float>();
+	peakSpectrum = TArrayView<float>();
+	peakHoldTimers = TArrayView<float>();
+	arenaOffset = INDEX_NONE;
+}
+
+void FTrackData::ReserveSpectrumBuffers(FSpectrumArena& arena)
+{
+	// Raw, normalized, envelope, peak and peak hold, back to back so a track's update stays within its own lines
+	arenaOffset = arena.Reserve(SpectrumBufferCount * FSpectrumArena::GetBlockStride(spectrumResolution));
+}
+
+void FTrackData::BindSpectrumBuffers(const FSpectrumArena& arena)
+{
+	const int32 stride = FSpectrumArena::GetBlockStride(spectrumResolution);
+	TArrayView<float> buffers = arena.GetBlock(arenaOffset, SpectrumBufferCount * stride);
+	spectrum = buffers.Slice(0, spectrumResolution);
+	normalizedSpectrum = buffers.Slice(stride, spectrumResolution);
+	envelopeSpectrum = buffers.Slice(2 * stride, spectrumResolution);
+	peakSpectrum = buffers.Slice(3 * stride, spectrumResolution);
+	peakHoldTimers = buffers.Slice(4 * stride, spectrumResolution);
+
+	for (float& band : spectrum) band = -spectrumClamp;
+	BuildNormalizedSpectrum();
+}
+
 void FTrackData::UpdateSpectrum(AMusicController* musicController)
 {
-	if (!isArmed) return;
+	if (!isArmed || spectrum.Num() == 0) return;
+	SYNTH_VISUALIZER_SCOPE(SpectrumAnalysis);
 
-	spectrum = musicController->CalculateFrequencySpectrum(trackInstance, musicController->GetCurrentSongTime()/* + timeOffset*/, spectrumTimeSlice, spectrumResolution);
+	if (spectrogram.IsValid())
+	{
+		spectrogram.ReadFrame(spectrogram.GetFrameIndex(musicController->GetSpectrumSampleTime()), spectrum.GetData());
+	}
+	else if (liveInput.IsValid())
+	{
+		// Always the newest audio, live input has no song time to sample at
+		if (liveFileSource.IsValid()) liveFileSource->PumpRealtime(*liveInput);
+		liveInput->Update();
+
+		int32 numHistory = 0;
+		const float* history = liveInput->GetHistory(numHistory);
+		const int32 sampleRate = liveInput->GetSampleRate();
+		analyzer.CalculateFrequencySpectrum(history, numHistory, sampleRate, (float)numHistory / sampleRate, spectrumTimeSlice, spectrumResolution, spectrumWindow, spectrum);
+	}
+	else if (workerSlot != INDEX_NONE)
+	{
+		// Keeps the last published frame if the worker hasn't produced a new one yet
+		musicController->GetAnalysisWorker()->ReadSpectrum(workerSlot, spectrum);
+	}
+	else if (musicController->IsUsingBlueprintSpectrum())
+	{
+		// The VM always hands back a fresh array, the one path that still allocates per update
+		const TArray<float> blueprintSpectrum = musicController->CalculateFrequencySpectrum(trackInstance, musicController->GetSpectrumSampleTime()/* + timeOffset*/, spectrumTimeSlice, spectrumResolution);
+		FMemory::Memcpy(spectrum.GetData(), blueprintSpectrum.GetData(), FMath::Min(spectrum.Num(), blueprintSpectrum.Num()) * sizeof(float));
+	}
+	else if (pcmStream.IsValid())
+	{
+		analyzer.CalculateFrequencySpectrum(*pcmStream, musicController->GetSpectrumSampleTime(), spectrumTimeSlice, spectrumResolution, spectrumWindow, spectrum);
+	}
+	else
+	{
+		analyzer.CalculateFrequencySpectrum(*pcm, musicController->GetSpectrumSampleTime(), spectrumTimeSlice, spectrumResolution, spectrumWindow, spectrum);
+	}
 
 	for (int i = 0; i < /*spectrumResolution*/spectrum.Num(); i++)
 	{
@@ -63,33 +299,128 @@ void FTrackData::UpdateSpectrum(AMusicController* musicController)
 			minFrequency = frequency;
 		}
 	}
+
+	BuildNormalizedSpectrum();
+}
+
+void FTrackData::UpdateEnvelopes(float DeltaTime)
+{
+	if (!isArmed) return;
+	SYNTH_VISUALIZER_SCOPE(SpectrumEnvelopes);
+
+	const int32 count = normalizedSpectrum.Num();
+	if (count == 0) return;
+
+	SynthDSP::FEnvelopeSettings settings;
+	settings.attackCoefficient = SynthDSP::EnvelopeCoefficient(envelopeAttackTime, DeltaTime);
+	settings.releaseCoefficient = SynthDSP::EnvelopeCoefficient(envelopeReleaseTime, DeltaTime);
+	settings.peakHoldTime = peakHoldTime;
+	settings.peakReleaseCoefficient = SynthDSP::EnvelopeCoefficient(peakReleaseTime, DeltaTime);
+	SynthDSP::UpdateEnvelopes(normalizedSpectrum.GetData(), envelopeSpectrum.GetData(), peakSpectrum.GetData(), peakHoldTimers.GetData(), count, DeltaTime, settings);
+}
+
+void FTrackData::BuildNormalizedSpectrum()
+{
+	SYNTH_VISUALIZER_SCOPE(NormalizeSpectrum);
+	const int32 count = FMath::Min(spectrum.Num(), normalizedSpectrum.Num());
+	SynthDSP::NormalizeSpectrum(spectrum.GetData(), normalizedSpectrum.GetData(), count, spectrumClamp, spectrumPowerFactor);
+}
+
+bool FTrackData::ArmLiveInput(AMusicController* musicController)
+{
+	if (musicController->IsUsingBlueprintSpectrum())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Live track (%s) ignores the blueprint spectrum override."), *(musicController->GetName()), *(trackID.ToString()));
+	}
+
+	const float historySeconds = spectrumTimeSlice * LiveHistorySlices;
+	FAudioDevice* audioDevice = GEngine ? GEngine->GetMainAudioDeviceRaw() : nullptr;
+	if (audioDevice != nullptr)
+	{
+		// Listening starts once the controller activates the track, a song prepared in the background stays quiet until then
+		liveInput = MakeShared<FSynthLiveInput, ESPMode::ThreadSafe>((int32)audioDevice->GetSampleRate(), historySeconds);
+		return true;
+	}
+
+	// Headless, play the track asset into the input instead so everything downstream runs the same
+	FDecodedPCMPtr sourcePCM = trackInstance != nullptr ? FSynthPCMCache::Get().Acquire(trackInstance, ESynthPCMFormat::Float) : FDecodedPCMPtr();
+	if (!sourcePCM.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): No audio device or track asset to feed live track (%s)."), *(musicController->GetName()), *(trackID.ToString()));
+		liveInput.Reset();
+		return false;
+	}
+
+	liveInput = MakeShared<FSynthLiveInput, ESPMode::ThreadSafe>(sourcePCM->sampleRate, historySeconds);
+	liveFileSource = MakeShared<FSynthFileAudioSource, ESPMode::ThreadSafe>(sourcePCM);
+	UE_LOG(LogTemp, Log, TEXT("(%s): No audio device, live track (%s) is fed from its track asset."), *(musicController->GetName()), *(trackID.ToString()));
+	return true;
+}
+
+void FTrackData::PrepareAnalyzer()
+{
+	if (liveInput.IsValid())
+	{
+		analyzer.PrepareFraming(liveInput->GetSampleRate(), spectrumTimeSlice, spectrumResolution, spectrumWindow, false);
+	}
+	else if (pcmStream.IsValid())
+	{
+		analyzer.PrepareFraming(pcmStream->GetSampleRate(), spectrumTimeSlice, spectrumResolution, spectrumWindow, true);
+	}
+	else if (pcm.IsValid())
+	{
+		analyzer.PrepareFraming(pcm->sampleRate, spectrumTimeSlice, spectrumResolution, spectrumWindow, false);
+	}
+}
+
+void FTrackData::StartLiveInput(AMusicController* musicController)
+{
+	// Tracks fed from their own asset have nothing to listen to
+	if (!liveInput.IsValid() || liveFileSource.IsValid()) return;
+
+	if (liveInput->ListenToSubmix(liveSubmix))
+	{
+		UE_LOG(LogTemp, Log, TEXT("(%s): Track (%s) listening to submix (%s)."), *(musicController->GetName()), *(trackID.ToString()), liveSubmix ? *(liveSubmix->GetName()) : TEXT("Master"));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Live track (%s) couldn't listen to its submix, the audio device is gone."), *(musicController->GetName()), *(trackID.ToString()));
+	}
+}
+
+void FTrackData::BuildBeatMap(AMusicController* musicController)
+{
+	beatMap.Reset();
+	if (spectrogram.IsValid())
+	{
+		beatMap.Build(spectrogram, spectrumTimeSlice);
+	}
+	else if (pcm.IsValid())
+	{
+		// Live tracks have no frames to look back over, so bake a throwaway spectrogram just for detection
+		FSpectrogram detectionSpectrogram;
+		FSpectrogram::Bake(*pcm, spectrumTimeSlice, spectrumResolution, spectrumWindow, bandLayout, BeatDetectionFrameRate, detectionSpectrogram);
+		beatMap.Build(detectionSpectrogram, spectrumTimeSlice);
+	}
+	else if (pcmStream.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Can't detect beats for streamed track (%s), the whole track is never decoded."), *(musicController->GetName()), *(trackID.ToString()));
+		return;
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Can't detect beats for track (%s) while using the blueprint spectrum override."), *(musicController->GetName()), *(trackID.ToString()));
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("(%s): Track (%s) has %d onsets and %d beats at %.1f BPM."), *(musicController->GetName()), *(trackID.ToString()), beatMap.onsets.Num(), beatMap.beats.Num(), beatMap.tempo);
 }
 
 float FTrackData::EvaluateRawFrequency(float frequencyNormalized)
 {
 	if (!isArmed) return -spectrumClamp;
 
-	float freqNorm = FMath::Clamp(frequencyNormalized, 0.0f, 1.0f);
-	float freq = freqNorm * (spectrumResolution - 1);
-	int freqIndx = FMath::RoundToInt(freq);
-	return spectrum[freqIndx];
-
-	//float freq = FMath::Clamp<float>(frequencyNormalized, 0.0f, 1.0f);
-	//int floorFreq = FMath::FloorToInt(freq);
-	//int ceilFreq = FMath::CeilToInt(freq);
-
-	//float frequencyValueA, frequencyValueB;
-	//frequencyValueA = spectrum[floorFreq];
-	//if (floorFreq == ceilFreq || ceilFreq >= 1)
-	//{
-	//	return frequencyValueA;
-	//}
-	//else
-	//{
-	//	frequencyValueB = spectrum[ceilFreq];
-	//	float remainder = freq - (float)(floorFreq);
-	//	return FMath::Lerp(frequencyValueA, frequencyValueB, remainder);
-	//}
+	return SampleBands(spectrum, frequencyNormalized);
 }
 
 float FTrackData::EvaluateClampedFrequency(float frequencyRange)
@@ -102,13 +433,95 @@ float FTrackData::EvaluateClampedFrequency(float frequencyRange)
 float FTrackData::EvaluateNormalizedFrequency(float frequencyRange)
 {
 	if (!isArmed) return 0.0f;
+	CountSpectrumQueries(1);
 
 	//float clampedFrequency = EvaluateClampedFrequency(frequencyRange);
 	//return (clampedFrequency - minFrequency) / (maxFrequency - minFrequency);
-	float clampedFrequency = EvaluateClampedFrequency(frequencyRange);
-	float normalizedFrequency = (clampedFrequency + spectrumClamp) / (2 * spectrumClamp);
-	float powerFrequency = FMath::Pow(normalizedFrequency, spectrumPowerFactor);
-	return powerFrequency;
+	return SampleBands(normalizedSpectrum, frequencyRange);
+}
+
+void FTrackData::EvaluateNormalizedFrequencies(const float* frequenciesNormalized, int32 count, float* outValues)
+{
+	if (!isArmed)
+	{
+		FMemory::Memzero(outValues, count * sizeof(float));
+		return;
+	}
+
+	SYNTH_VISUALIZER_SCOPE(EvaluateSpectrum);
+	CountSpectrumQueries(count);
+	for (int i = 0; i < count; i++)
+	{
+		outValues[i] = SampleBands(normalizedSpectrum, frequenciesNormalized[i]);
+	}
+}
+
+void FTrackData::EvaluateNormalizedBars(int32 barCount, float* outValues)
+{
+	if (!isArmed)
+	{
+		FMemory::Memzero(outValues, barCount * sizeof(float));
+		return;
+	}
+
+	SYNTH_VISUALIZER_SCOPE(EvaluateSpectrum);
+	CountSpectrumQueries(barCount);
+	const float barStep = 1.0f / barCount;
+	for (int i = 0; i < barCount; i++)
+	{
+		outValues[i] = SampleBands(normalizedSpectrum, i * barStep);
+	}
+}
+
+float FTrackData::EvaluateSignal(ESynthResponseSignal signal, float frequencyNormalized)
+{
+	if (!isArmed) return 0.0f;
+	CountSpectrumQueries(1);
+
+	return SampleBands(GetSignalBands(signal), frequencyNormalized);
+}
+
+void FTrackData::EvaluateSignals(ESynthResponseSignal signal, const float* frequenciesNormalized, int32 count, float* outValues)
+{
+	if (!isArmed)
+	{
+		FMemory::Memzero(outValues, count * sizeof(float));
+		return;
+	}
+
+	SYNTH_VISUALIZER_SCOPE(EvaluateSpectrum);
+	CountSpectrumQueries(count);
+	const TArrayView<const float> bands = GetSignalBands(signal);
+	for (int i = 0; i < count; i++)
+	{
+		outValues[i] = SampleBands(bands, frequenciesNormalized[i]);
+	}
+}
+
+SIZE_T FTrackData::GetSpectrumMemory() const
+{
+	// Memory mapped spectrogram frames aren't heap, only a bake owns its frames. Band buffers are counted with the arena.
+	return spectrogram.frames.GetAllocatedSize() + beatMap.onsets.GetAllocatedSize() + beatMap.beats.GetAllocatedSize() + (pcmStream.IsValid() ? pcmStream->GetAllocatedSize() : 0)
+		+ (liveInput.IsValid() ? liveInput->GetAllocatedSize() : 0);
+}
+
+float FTrackData::SampleBands(TArrayView<const float> bands, float frequencyNormalized) const
+{
+	if (bands.Num() == 0) return 0.0f;
+
+	const float band = FMath::Clamp(frequencyNormalized, 0.0f, 1.0f) * (bands.Num() - 1);
+	if (!bandLayout.interpolateBands) return bands[FMath::RoundToInt(band)];
+
+	const int32 lowerBand = FMath::FloorToInt(band);
+	const int32 upperBand = FMath::Min(lowerBand + 1, bands.Num() - 1);
+	return FMath::Lerp(bands[lowerBand], bands[upperBand], band - lowerBand);
+}
+
+TArrayView<const float> FTrackData::GetSignalBands(ESynthResponseSignal signal) const
+{
+	if (signal == ESynthResponseSignal::Envelope) return envelopeSpectrum;
+	if (signal == ESynthResponseSignal::Peak) return peakSpectrum;
+	return normalizedSpectrum;
 }
 
 // Sets default values
@@ -116,16 +529,84 @@ AMusicController::AMusicController()
 {
 	isArmed = false;
 	isPlayingTrack = false;
+	useBlueprintSpectrum = false;
+	useParallelTrackUpdates = false;
+	trackGeneration = 1;
+	spectrumMemory = 0;
+	isUpdatingResponders = false;
+	hasUnregisteredResponders = false;
 	songPercent = 0.0f;
+	songTime = 0.0f;
 	songDuration = 0.0f;
+	initialAudioTime = 0.0f;
+	initialPlaybackPercent = 0.0f;
+	clockDrift = 0.0f;
 	trackMap = TMap<FName, FTrackData*>();
+	pendingState = EPendingSongState::None;
+	pendingSongIndex = INDEX_NONE;
+	currentSongIndex = INDEX_NONE;
+	switchWhenPrepared = false;
+	audioStopRequested = false;
 	PrimaryActorTick.bCanEverTick = true;
 	AudioComponent = CreateDefaultSubobject<UAudioComponent>(FName("Audio Player"));
 }
 
-void AMusicController::ArmTrackTest(FSong trackData)
+void AMusicController::ArmTrackTest(const FSong& trackData)
+{
+	BeginPreparingSong(trackData, INDEX_NONE, true);
+}
+
+bool AMusicController::PrepareSong(int32 playlistIndex)
+{
+	if (!Playlist.IsValidIndex(playlistIndex))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Can't prepare song %d, the playlist has %d songs."), *GetName(), playlistIndex, Playlist.Num());
+		return false;
+	}
+
+	return BeginPreparingSong(Playlist[playlistIndex], playlistIndex, false);
+}
+
+bool AMusicController::IsSongPrepared() const
+{
+	return pendingState == EPendingSongState::Ready;
+}
+
+int32 AMusicController::GetCurrentSongIndex() const
 {
+	return currentSongIndex;
+}
 
+bool AMusicController::SwitchToPreparedSong(bool playSong, float fadeInDuration)
+{
+	if (pendingState != EPendingSongState::Ready)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Trying to switch songs but no song is prepared."), *GetName());
+		return false;
+	}
+
+	// Cleared before stopping so a finish callback from the stop can't switch again
+	FSong preparedSong = MoveTemp(pendingSong);
+	const int32 preparedSongIndex = pendingSongIndex;
+	pendingSong = FSong();
+	pendingLoadHandle.Reset();
+	pendingState = EPendingSongState::None;
+	pendingSongIndex = INDEX_NONE;
+	switchWhenPrepared = false;
+
+	if (isPlayingTrack) StopTrack();
+	DisarmTrack();
+
+	// The prepared tracks are already armed, moving them over is all that's left
+	MasterTrack = MoveTemp(preparedSong.masterTrack);
+	detailTracks = MoveTemp(preparedSong.detailTracks);
+	currentSongIndex = preparedSongIndex;
+	ActivateArmedTracks();
+	if (!isArmed) return false;
+
+	UE_LOG(LogTemp, Log, TEXT("(%s): Switched to song %d."), *GetName(), currentSongIndex);
+	if (playSong) PlayTrack(0.0f, fadeInDuration);
+	return true;
 }
 
 void AMusicController::PlayTrack(float startPercent, float fadeInDuration)
@@ -147,12 +628,24 @@ void AMusicController::PlayTrack(float startPercent, float fadeInDuration)
 	songTime = songPercent * songDuration;
 	initialAudioTime = UGameplayStatics::GetAudioTimeSeconds(GetWorld()) - songTime;
 	initialPlaybackPercent = songPercent;
+	clockDrift = 0.0f;
+	for (FTrackData* track : armedTracks)
+	{
+		track->beatMap.Seek(GetSpectrumSampleTime());
+		// Start decoding around the new position before the first spectrum asks for it
+		if (track->pcmStream.IsValid()) track->pcmStream->SetPlayhead(GetSpectrumSampleTime());
+	}
 
+	// Restarting an active component stops its current sound first, which also reports through OnAudioFinished
+	if (AudioComponent->IsPlaying()) audioStopRequested = true;
 	AudioComponent->Sound = Cast<USoundBase>(MasterTrack.trackInstance);
 	//AudioComponent->Play(songTime);
-	AudioComponent->FadeIn(fadeInDuration, 1.0f, songTime, EAudioFaderCurve::Linear);
+	if (AudioComponent->Sound != nullptr) AudioComponent->FadeIn(fadeInDuration, 1.0f, songTime, EAudioFaderCurve::Linear);
 	OnTrackStart.Broadcast();
 	UE_LOG(LogTemp, Log, TEXT("(%s): Playing track..."), *GetName());
+
+	// Most of the song is left to get the next one ready
+	if (AdvancePlaylist && pendingState == EPendingSongState::None) PrepareNextSong();
 }
 
 void AMusicController::PauseTrack()
@@ -169,6 +662,10 @@ void AMusicController::ResumeTrack()
 	isPlayingTrack = true;
 	//AudioComponent->Play(songTime);
 	AudioComponent->SetPaused(false);
+
+	// The clock froze while paused, pick it back up from where it stopped
+	initialAudioTime = UGameplayStatics::GetAudioTimeSeconds(GetWorld()) - songTime;
+	clockDrift = 0.0f;
 }
 
 void AMusicController::StopTrack()
@@ -176,6 +673,9 @@ void AMusicController::StopTrack()
 	isPlayingTrack = false;
 	songTime = 0.0f;
 	songPercent = 0.0f;
+
+	// Stop() reports back through OnAudioFinished, which must not mistake it for the song ending
+	if (AudioComponent->IsPlaying()) audioStopRequested = true;
 	AudioComponent->Stop();
 	OnTrackEnd.Broadcast();
 	UE_LOG(LogTemp, Log, TEXT("(%s): Track finished."), *GetName());
@@ -188,15 +688,106 @@ void AMusicController::ResetTrack()
 
 float AMusicController::EvaluateNormalizedSpectrum(float normalizedFrequency, FName trackID)
 {
-	if (!trackMap.Contains(trackID))
+	FTrackData** track = trackMap.Find(trackID);
+	return track != nullptr ? (*track)->EvaluateNormalizedFrequency(normalizedFrequency) : 0.0f;
+}
+
+bool AMusicController::ResolveTrackResponse(FTrackResponse& response) const
+{
+	FTrackData* const* track = trackMap.Find(response.trackName);
+	response.trackHandle = track != nullptr ? armedTracks.Find(*track) : INDEX_NONE;
+	response.trackGeneration = trackGeneration;
+	return response.trackHandle != INDEX_NONE;
+}
+
+float AMusicController::EvaluateTrackResponse(FTrackResponse& response)
+{
+	if (response.trackGeneration != trackGeneration) ResolveTrackResponse(response);
+	if (response.trackHandle == INDEX_NONE) return 0.0f;
+
+	return armedTracks[response.trackHandle]->EvaluateSignal(response.signal, response.frequencyTune);
+}
+
+void AMusicController::EvaluateTrackResponseBatch(FTrackResponse& response, const TArray<float>& normalizedFrequencies, TArray<float>& outValues)
+{
+	if (outValues.Num() != normalizedFrequencies.Num()) outValues.SetNumUninitialized(normalizedFrequencies.Num());
+	if (response.trackGeneration != trackGeneration) ResolveTrackResponse(response);
+
+	if (response.trackHandle == INDEX_NONE)
 	{
-		return 0.0f;
+		FMemory::Memzero(outValues.GetData(), outValues.Num() * sizeof(float));
+		return;
 	}
-	else
+
+	armedTracks[response.trackHandle]->EvaluateSignals(response.signal, normalizedFrequencies.GetData(), normalizedFrequencies.Num(), outValues.GetData());
+}
+
+void AMusicController::RegisterResponder(AMusicResponder* responder)
+{
+	if (responder == nullptr) return;
+
+	UClass* responderClass = responder->GetClass();
+	FMusicResponderGroup* group = responderGroups.FindByPredicate([responderClass](const FMusicResponderGroup& existingGroup) { return existingGroup.responderClass == responderClass; });
+	if (group == nullptr)
 	{
-		FTrackData* track = trackMap[trackID];
-		return track->EvaluateNormalizedFrequency(normalizedFrequency);
+		group = &responderGroups.AddDefaulted_GetRef();
+		group->responderClass = responderClass;
 	}
+
+	group->responders.AddUnique(responder);
+}
+
+void AMusicController::UnregisterResponder(AMusicResponder* responder)
+{
+	if (responder == nullptr) return;
+
+	for (FMusicResponderGroup& group : responderGroups)
+	{
+		if (group.responderClass != responder->GetClass()) continue;
+
+		if (!isUpdatingResponders)
+		{
+			group.responders.Remove(responder);
+			continue;
+		}
+
+		// Removing would shift the rest of the group under the update loop and skip a responder
+		const int32 index = group.responders.Find(responder);
+		if (index != INDEX_NONE)
+		{
+			group.responders[index] = nullptr;
+			hasUnregisteredResponders = true;
+		}
+	}
+}
+
+void AMusicController::EvaluateNormalizedSpectrumBatch(const TArray<float>& normalizedFrequencies, FName trackID, TArray<float>& outValues)
+{
+	if (outValues.Num() != normalizedFrequencies.Num()) outValues.SetNumUninitialized(normalizedFrequencies.Num());
+
+	FTrackData** track = trackMap.Find(trackID);
+	if (track == nullptr)
+	{
+		FMemory::Memzero(outValues.GetData(), outValues.Num() * sizeof(float));
+		return;
+	}
+
+	(*track)->EvaluateNormalizedFrequencies(normalizedFrequencies.GetData(), normalizedFrequencies.Num(), outValues.GetData());
+}
+
+void AMusicController::EvaluateNormalizedSpectrumBars(int32 barCount, FName trackID, TArray<float>& outValues)
+{
+	barCount = FMath::Max(0, barCount);
+	if (outValues.Num() != barCount) outValues.SetNumUninitialized(barCount);
+
+	FTrackData** track = trackMap.Find(trackID);
+	if (track == nullptr)
+	{
+		FMemory::Memzero(outValues.GetData(), outValues.Num() * sizeof(float));
+		return;
+	}
+
+	(*track)->EvaluateNormalizedBars(barCount, outValues.GetData());
 }
 
 float AMusicController::GetCurrentSongTime()
@@ -225,24 +816,52 @@ FString AMusicController::GetCurrentTrackTimeText()
 	return FString::Printf(TEXT("%02d : %02d : %02d"), trackMinutes, trackSeconds, trackDeci);
 }
 
+float AMusicController::GetTrackTempo(FName trackID)
+{
+	FTrackData* track = GetTrackData(trackID);
+	return track != nullptr ? track->beatMap.tempo : 0.0f;
+}
+
 void AMusicController::BeginPlay()
 {
 	Super::BeginPlay();
 	Initialize();
+
+	// Register once armed so waiting responders resolve against real tracks
+	if (USynthMusicSubsystem* musicSubsystem = USynthMusicSubsystem::Get(this)) musicSubsystem->RegisterController(this);
 	if (isArmed && PlayOnStart) PlayTrack(SongStartPercent);
 }
 
+void AMusicController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USynthMusicSubsystem* musicSubsystem = USynthMusicSubsystem::Get(this)) musicSubsystem->UnregisterController(this);
+	CancelPendingSong();
+	Super::EndPlay(EndPlayReason);
+}
+
 void AMusicController::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	UpdatePendingSong();
 	UpdateTrackState(DeltaTime);
+	UpdateResponders(DeltaTime);
 	if (enableDebugging) DoDebugLogic();
+
+	// Accumulated so several controllers in one world add up in the capture
+	CSV_CUSTOM_STAT(SynthVisualizer, ArmedTracks, armedTracks.Num(), ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(SynthVisualizer, SpectrumMemoryMB, spectrumMemory / (1024.0f * 1024.0f), ECsvCustomStatOp::Accumulate);
 }
 
 
 void AMusicController::BeginDestroy()
 {
 	if (IsRooted()) RemoveFromRoot();
+	// Preparation tasks write into pendingSong
+	for (TFuture<bool>& task : pendingTasks)
+	{
+		if (task.IsValid()) task.Wait();
+	}
+	analysisWorker.Reset();
 	Super::BeginDestroy();
 }
 
@@ -250,6 +869,22 @@ void AMusicController::Initialize()
 {
 	AudioComponent->OnAudioPlaybackPercent.AddDynamic(this, &AMusicController::UpdatePlaybackPercent);
 	AudioComponent->OnAudioFinished.AddDynamic(this, &AMusicController::OnAudioFinished);
+
+	// Only round trip through the BP VM if a child blueprint actually overrides the spectrum event
+	useBlueprintSpectrum = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AMusicController, CalculateFrequencySpectrum));
+	if (useBlueprintSpectrum)
+	{
+		UE_LOG(LogTemp, Log, TEXT("(%s): Using blueprint CalculateFrequencySpectrum override."), *GetName());
+	}
+
+	const bool hasMasterSource = MasterTrack.track != nullptr || !MasterTrack.trackAsset.IsNull() || MasterTrack.analyzeLiveInput;
+	if (!hasMasterSource && Playlist.Num() > 0)
+	{
+		MasterTrack = Playlist[0].masterTrack;
+		detailTracks = Playlist[0].detailTracks;
+		currentSongIndex = 0;
+	}
+
 	ArmTrack();
 }
 
@@ -258,30 +893,49 @@ void AMusicController::ArmTrack()
 	if (isArmed) DisarmTrack();
 
 	MasterTrack.ArmTrack(this);
+	if (MasterTrack.isArmed)
+	{
+		// Duplicates get dropped on activation, don't decode them first
+		TSet<FName> trackIDs;
+		trackIDs.Add(MasterTrack.trackID);
+		for (FTrackData& detailTrack : detailTracks)
+		{
+			bool isDuplicate = false;
+			trackIDs.Add(detailTrack.trackID, &isDuplicate);
+			if (!isDuplicate) detailTrack.ArmTrack(this, MasterTrack.trackInstance);
+		}
+	}
+
+	ActivateArmedTracks();
+}
+
+void AMusicController::ActivateArmedTracks()
+{
 	if (!MasterTrack.isArmed)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to arm track. Couldn't arm master track."), *GetName());
 		return;
 	}
 
-	songDuration = MasterTrack.trackInstance->GetDuration();
+	// A live master without a track asset has no end, the clock just runs
+	songDuration = MasterTrack.trackInstance != nullptr ? MasterTrack.trackInstance->GetDuration() : 0.0f;
 	trackMap.Add(TTuple<FName, FTrackData*>(MasterTrack.trackID, &MasterTrack));
 	UE_LOG(LogTemp, Log, TEXT("(%s): Master track (%s) armed."), *GetName(), *(MasterTrack.trackID.ToString()));
 
-	TArray<FTrackData> tracksToRemove = TArray<FTrackData>();
+	// By index, removing by value would also drop the original of every duplicate ID
+	TArray<int32> tracksToRemove;
 	for (int i = 0; i < detailTracks.Num(); i++)
 	{
 		if (trackMap.Contains(detailTracks[i].trackID))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("(%s): Trying to arm track with duplicate track ID (%s)"), *GetName(), *(detailTracks[i].trackID.ToString()));
-			tracksToRemove.Add(detailTracks[i]);
+			tracksToRemove.Add(i);
 			continue;
 		}
 
-		detailTracks[i].ArmTrack(this, MasterTrack.trackInstance);
 		if (!detailTracks[i].isArmed)
 		{
-			tracksToRemove.Add(detailTracks[i]);
+			tracksToRemove.Add(i);
 			continue;
 		}
 
@@ -289,50 +943,381 @@ void AMusicController::ArmTrack()
 		UE_LOG(LogTemp, Warning, TEXT("(%s): Armed detail track (%s)"), *GetName(), *(detailTracks[i].trackID.ToString()));
 	}
 
-	for (int i = 0; i < tracksToRemove.Num(); i++)
+	for (int i = tracksToRemove.Num() - 1; i >= 0; i--)
+	{
+		detailTracks[tracksToRemove[i]].DisarmTrack();
+		detailTracks.RemoveAt(tracksToRemove[i]);
+	}
+
+	// Removing tracks shifts detailTracks, so the map is rebuilt from the final storage
+	trackMap.Reset();
+	armedTracks.Reset();
+	armedTracks.Add(&MasterTrack);
+	for (int i = 0; i < detailTracks.Num(); i++)
+	{
+		if (detailTracks[i].isArmed) armedTracks.Add(&detailTracks[i]);
+	}
+
+	for (FTrackData* track : armedTracks) trackMap.Add(track->trackID, track);
+	trackGeneration++;
+
+	// Bound after the removals above, so every view points at a track's final storage
+	spectrumArena.Reset();
+	for (FTrackData* track : armedTracks) track->ReserveSpectrumBuffers(spectrumArena);
+	spectrumArena.Allocate();
+	for (FTrackData* track : armedTracks) track->BindSpectrumBuffers(spectrumArena);
+	for (FTrackData* track : armedTracks) track->StartLiveInput(this);
+
+	if (AnalyzeOnWorkerThread && !useBlueprintSpectrum) StartAnalysisWorker();
+
+	spectrumMemory = spectrumArena.GetAllocatedSize();
+	for (FTrackData* track : armedTracks) spectrumMemory += track->GetSpectrumMemory();
+	INC_MEMORY_STAT_BY(STAT_SynthSpectrumMemory, spectrumMemory);
+	INC_DWORD_STAT_BY(STAT_SynthArmedTracks, armedTracks.Num());
+
+	// Only fan out when more than one track still runs a full FFT on the game thread, lookups aren't worth a task
+	int32 gameThreadAnalysisTracks = 0;
+	for (FTrackData* track : armedTracks)
 	{
-		detailTracks.Remove(tracksToRemove[i]);
+		if ((track->pcm.IsValid() || track->pcmStream.IsValid() || track->liveInput.IsValid()) && track->workerSlot == INDEX_NONE && !track->spectrogram.IsValid())
+		{
+			track->PrepareAnalyzer();
+			gameThreadAnalysisTracks++;
+		}
 	}
+	useParallelTrackUpdates = ParallelTrackUpdates && !useBlueprintSpectrum && gameThreadAnalysisTracks > 1;
 
 	isArmed = true;
 	UE_LOG(LogTemp, Log, TEXT("(%s): Track armed."), *GetName());
 }
 
+void AMusicController::StartAnalysisWorker()
+{
+	analysisWorker = MakeUnique<FSpectrumAnalysisWorker>(WorkerAnalysisRate);
+
+	// Baked tracks are just a lookup, only live analysis is worth moving off the game thread
+	for (FTrackData* track : armedTracks)
+	{
+		if (!track->isArmed || track->spectrogram.IsValid() || !track->pcm.IsValid()) continue;
+		track->workerSlot = analysisWorker->AddTrack(track->pcm, track->spectrumResolution, track->spectrumTimeSlice, track->spectrumWindow, track->bandLayout);
+	}
+
+	analysisWorker->Start();
+}
+
 void AMusicController::DisarmTrack()
 {
 	if (!isArmed) return;
+	DEC_MEMORY_STAT_BY(STAT_SynthSpectrumMemory, spectrumMemory);
+	DEC_DWORD_STAT_BY(STAT_SynthArmedTracks, armedTracks.Num());
+	spectrumMemory = 0;
+	analysisWorker.Reset();
+	armedTracks.Reset();
+	trackGeneration++;
+	useParallelTrackUpdates = false;
+	MasterTrack.DisarmTrack();
+	for (int i = 0; i < detailTracks.Num(); i++) detailTracks[i].DisarmTrack();
+	spectrumArena.Reset();
 	trackMap.Empty();
 	isArmed = false;
 }
 
 void AMusicController::UpdateTrackState(float DeltaTime)
 {
+	UpdatePlaybackClock(DeltaTime);
+	if (analysisWorker.IsValid()) analysisWorker->SetPlaybackClock(GetSpectrumSampleTime(), isPlayingTrack);
+
 	if (isPlayingTrack)
 	{
 		UpdateFrequencySpectrums();
+		UpdateSpectrumEnvelopes(DeltaTime);
+		UpdateMusicEvents();
 	}
 }
 
 void AMusicController::UpdateFrequencySpectrums()
 {
-	if (MasterTrack.isArmed) MasterTrack.UpdateSpectrum(this);
+	SYNTH_VISUALIZER_SCOPE(UpdateFrequencySpectrums);
 
-	for (int i = 0; i < detailTracks.Num(); i++)
+	int32 numBins = 0;
+	for (const FTrackData* track : armedTracks) numBins += track->spectrum.Num();
+	INC_DWORD_STAT_BY(STAT_SynthSpectrumBins, numBins);
+	CSV_CUSTOM_STAT(SynthVisualizer, SpectrumBins, numBins, ECsvCustomStatOp::Accumulate);
+
+	// Every track owns its analyzer scratch, so tracks can update in parallel. ParallelFor joins before responders read.
+	if (useParallelTrackUpdates)
 	{
-		if (!detailTracks[i].isArmed) continue;
-		detailTracks[i].UpdateSpectrum(this);
+		ParallelFor(armedTracks.Num(), [this](int32 trackIndex)
+		{
+			armedTracks[trackIndex]->UpdateSpectrum(this);
+		});
+		return;
 	}
+
+	for (int i = 0; i < armedTracks.Num(); i++)
+	{
+		armedTracks[i]->UpdateSpectrum(this);
+	}
+}
+
+void AMusicController::UpdateSpectrumEnvelopes(float DeltaTime)
+{
+	// Kept off the parallel track update, it's a few multiplies per bin and needs the frame's DeltaTime
+	for (FTrackData* track : armedTracks) track->UpdateEnvelopes(DeltaTime);
+}
+
+void AMusicController::UpdateMusicEvents()
+{
+	SYNTH_VISUALIZER_SCOPE(MusicEvents);
+	for (FTrackData* track : armedTracks)
+	{
+		if (!track->beatMap.HasEvents()) continue;
+
+		const FName trackID = track->trackID;
+		track->beatMap.Advance(GetSpectrumSampleTime(), [this, trackID](EMusicEventType eventType, const FMusicEvent& musicEvent)
+		{
+			FMusicControllerRhythmEvent& rhythmEvent = eventType == EMusicEventType::Beat ? OnBeat : OnOnset;
+			rhythmEvent.Broadcast(trackID, musicEvent.strength, musicEvent.band);
+		});
+	}
+}
+
+void AMusicController::UpdateResponders(float DeltaTime)
+{
+	SYNTH_VISUALIZER_SCOPE(UpdateResponders);
+	int32 numResponders = 0;
+
+	// Indexed, and the group looked up again each time, so a responder registering mid pass can't invalidate the loop.
+	// Unregistering mid pass only nulls its entry, see UnregisterResponder.
+	isUpdatingResponders = true;
+	for (int group = 0; group < responderGroups.Num(); group++)
+	{
+		for (int i = 0; i < responderGroups[group].responders.Num(); i++)
+		{
+			AMusicResponder* responder = responderGroups[group].responders[i];
+			if (responder == nullptr) continue;
+			responder->UpdateMusicResponse(DeltaTime);
+			numResponders++;
+		}
+	}
+	isUpdatingResponders = false;
+
+	if (hasUnregisteredResponders)
+	{
+		for (FMusicResponderGroup& group : responderGroups) group.responders.Remove(nullptr);
+		hasUnregisteredResponders = false;
+	}
+
+	INC_DWORD_STAT_BY(STAT_SynthRespondersUpdated, numResponders);
+	CSV_CUSTOM_STAT(SynthVisualizer, RespondersUpdated, numResponders, ECsvCustomStatOp::Accumulate);
+}
+
+void AMusicController::UpdatePlaybackClock(float DeltaTime)
+{
+	if (!isPlayingTrack) return;
+
+	// Bleed the last measured drift into the clock over a few frames instead of stepping it
+	const float correction = clockDrift * FMath::Clamp(DeltaTime / ClockDriftCorrectionTime, 0.0f, 1.0f);
+	initialAudioTime -= correction;
+	clockDrift -= correction;
+
+	const float audioTime = UGameplayStatics::GetAudioTimeSeconds(GetWorld()) - initialAudioTime;
+	songTime = songDuration > 0.0f ? FMath::Clamp(audioTime, 0.0f, songDuration) : FMath::Max(audioTime, 0.0f);
+	songPercent = songDuration > 0.0f ? songTime / songDuration : 0.0f;
 }
 
 void AMusicController::UpdatePlaybackPercent(const USoundWave* playingSoundWave, const float playbackPercent)
 {
-	songPercent = initialPlaybackPercent + playbackPercent;
-	songTime = songPercent * songDuration;
+	// Playback percent only arrives once per audio buffer, so it corrects the interpolated clock rather than driving it
+	const float reportedTime = (initialPlaybackPercent + playbackPercent) * songDuration;
+	const float drift = reportedTime - (UGameplayStatics::GetAudioTimeSeconds(GetWorld()) - initialAudioTime);
+	if (FMath::Abs(drift) > ClockSnapThreshold)
+	{
+		initialAudioTime -= drift;
+		clockDrift = 0.0f;
+	}
+	else
+	{
+		clockDrift = drift;
+	}
 }
 
 void AMusicController::OnAudioFinished()
 {
+	if (audioStopRequested)
+	{
+		audioStopRequested = false;
+		return;
+	}
+
+	// A natural end from here on. If the audio stopped early the song still ends rather than keep a silent clock running.
+	if (songDuration > 0.0f && songTime < songDuration - SongEndTolerance)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Audio finished at %.2fs of %.2fs, ending the song early."), *GetName(), songTime, songDuration);
+	}
+
 	StopTrack();
+	if (!AdvancePlaylist) return;
+
+	if (pendingState == EPendingSongState::Ready)
+	{
+		SwitchToPreparedSong(true);
+	}
+	else if (pendingState != EPendingSongState::None)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Next song isn't prepared yet, switching once it is."), *GetName());
+		switchWhenPrepared = true;
+	}
+}
+
+bool AMusicController::BeginPreparingSong(const FSong& song, int32 playlistIndex, bool switchWhenReady)
+{
+	// Analysis tasks can't be interrupted part way, so one song prepares at a time
+	if (pendingState == EPendingSongState::Preparing)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Can't prepare a song while another one is being analyzed."), *GetName());
+		return false;
+	}
+
+	CancelPendingSong();
+	pendingSong = song;
+	pendingSongIndex = playlistIndex;
+	switchWhenPrepared = switchWhenReady;
+	pendingState = EPendingSongState::Loading;
+
+	TArray<FSoftObjectPath> wavesToLoad;
+	auto addWave = [&wavesToLoad](const FTrackData& trackData)
+	{
+		if (trackData.track == nullptr && !trackData.trackAsset.IsNull()) wavesToLoad.Add(trackData.trackAsset.ToSoftObjectPath());
+	};
+	addWave(pendingSong.masterTrack);
+	for (const FTrackData& detailTrack : pendingSong.detailTracks) addWave(detailTrack);
+
+	if (wavesToLoad.Num() == 0)
+	{
+		StartPendingPreparation();
+		return true;
+	}
+
+	pendingLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(wavesToLoad, FStreamableDelegate::CreateUObject(this, &AMusicController::StartPendingPreparation));
+	return true;
+}
+
+void AMusicController::PrepareNextSong()
+{
+	if (Playlist.Num() == 0) return;
+
+	int32 nextSongIndex = currentSongIndex + 1;
+	if (nextSongIndex >= Playlist.Num())
+	{
+		if (!LoopPlaylist) return;
+		nextSongIndex = 0;
+	}
+
+	PrepareSong(nextSongIndex);
+}
+
+void AMusicController::StartPendingPreparation()
+{
+	if (pendingState != EPendingSongState::Loading && pendingState != EPendingSongState::Caching) return;
+	pendingLoadHandle.Reset();
+
+	// UpdatePendingSong calls back in once the bakes have landed
+	if (IsPendingSongCaching())
+	{
+		pendingState = EPendingSongState::Caching;
+		return;
+	}
+	pendingState = EPendingSongState::Preparing;
+
+	pendingTracks.Reset();
+	pendingTasks.Reset();
+	pendingTracks.Add(&pendingSong.masterTrack);
+	for (FTrackData& detailTrack : pendingSong.detailTracks) pendingTracks.Add(&detailTrack);
+
+	TSet<FName> trackIDs;
+	for (FTrackData* track : pendingTracks)
+	{
+		bool isDuplicate = false;
+		trackIDs.Add(track->trackID, &isDuplicate);
+
+		// BeginArm touches UObjects and the audio device, only the decode and analysis go to the pool
+		if (isDuplicate || !track->BeginArm(this))
+		{
+			pendingTasks.Add(TFuture<bool>());
+			continue;
+		}
+
+		pendingTasks.Add(Async(EAsyncExecution::ThreadPool, [this, track]()
+		{
+			return track->PrepareAnalysis(this);
+		}));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("(%s): Preparing song (%d tracks) in the background."), *GetName(), pendingTracks.Num());
+}
+
+void AMusicController::UpdatePendingSong()
+{
+	if (pendingState == EPendingSongState::Caching) StartPendingPreparation();
+	if (pendingState != EPendingSongState::Preparing) return;
+	for (const TFuture<bool>& task : pendingTasks)
+	{
+		if (task.IsValid() && !task.IsReady()) return;
+	}
+
+	for (int i = 0; i < pendingTracks.Num(); i++)
+	{
+		if (!pendingTasks[i].IsValid() || !pendingTasks[i].Get()) continue;
+		pendingTracks[i]->FinishArm(this, i > 0 ? pendingSong.masterTrack.trackInstance : nullptr);
+	}
+	pendingTracks.Reset();
+	pendingTasks.Reset();
+
+	if (!pendingSong.masterTrack.isArmed)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to prepare song. Couldn't arm master track."), *GetName());
+		CancelPendingSong();
+		return;
+	}
+
+	pendingState = EPendingSongState::Ready;
+	UE_LOG(LogTemp, Log, TEXT("(%s): Song prepared."), *GetName());
+	OnSongPrepared.Broadcast();
+
+	if (switchWhenPrepared) SwitchToPreparedSong(true);
+}
+
+bool AMusicController::IsPendingSongCaching() const
+{
+	if (useBlueprintSpectrum) return false;
+
+	auto isCaching = [](const FTrackData& trackData) { return trackData.spectrogramAsset != nullptr && trackData.spectrogramAsset->IsCaching(); };
+	if (isCaching(pendingSong.masterTrack)) return true;
+	return pendingSong.detailTracks.ContainsByPredicate(isCaching);
+}
+
+void AMusicController::CancelPendingSong()
+{
+	if (pendingLoadHandle.IsValid())
+	{
+		pendingLoadHandle->CancelHandle();
+		pendingLoadHandle.Reset();
+	}
+
+	for (TFuture<bool>& task : pendingTasks)
+	{
+		if (task.IsValid()) task.Wait();
+	}
+	pendingTasks.Reset();
+	pendingTracks.Reset();
+
+	pendingSong.masterTrack.DisarmTrack();
+	for (FTrackData& detailTrack : pendingSong.detailTracks) detailTrack.DisarmTrack();
+	pendingSong = FSong();
+	pendingState = EPendingSongState::None;
+	pendingSongIndex = INDEX_NONE;
+	switchWhenPrepared = false;
 }
 
 USoundWave* AMusicController::GetTrack(FName trackID)
@@ -364,6 +1349,7 @@ FTrackData* AMusicController::GetTrackData(FName trackID)
 void AMusicController::DoDebugLogic()
 {
 	if (!isArmed || !isPlayingTrack) return;
+	SYNTH_VISUALIZER_SCOPE(DebugDraw);
 
 	FVector startPos = GetActorLocation();
 	for (int i = 1; i < MasterTrack.spectrumResolution; i++)
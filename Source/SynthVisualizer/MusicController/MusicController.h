@@ -5,11 +5,28 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Sound/SoundWave.h"
+#include "Async/Future.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include "SynthVisualizer/PCMCache/SynthPCMStream.h"
+#include "SynthVisualizer/LiveInput/SynthLiveInput.h"
+#include "SynthVisualizer/MusicController/SynthResponseSignal.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalysisWorker.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumArena.h"
+#include "SynthVisualizer/BeatMap/BeatMap.h"
 #include "MusicController.generated.h"
 
 class UAudioComponent;
+class USoundSubmix;
+class FSynthFileAudioSource;
+class USynthSpectrogramAsset;
+class AMusicResponder;
+struct FTrackResponse;
+struct FStreamableHandle;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMusicControllerEvent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FMusicControllerRhythmEvent, FName, trackID, float, strength, int32, band);
 
 USTRUCT(BlueprintType)
 struct FTrackData
@@ -21,6 +38,9 @@ public:
 	FName trackID;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Synth Visualization Track Properties")
 	USoundWave* track;
+	// Used when track is empty, so playlist songs only load their waves when they're prepared
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Synth Visualization Track Properties")
+	TSoftObjectPtr<USoundWave> trackAsset;
 	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
 	int32 spectrumResolution;
 	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
@@ -29,6 +49,44 @@ public:
 	float spectrumClamp;
 	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
 	float spectrumPowerFactor;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	ESpectrumWindowType spectrumWindow;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	FSpectrumBandLayout bandLayout;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	bool bakeSpectrum;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (EditCondition = "bakeSpectrum", ClampMin = "1", ClampMax = "240"))
+	float bakeFrameRate;
+	// Compact storage for the baked frames, dequantized as each frame is read
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (EditCondition = "bakeSpectrum"))
+	ESynthSpectrogramFormat bakeFormat;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	USynthSpectrogramAsset* spectrogramAsset;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	ESynthPCMFormat pcmFormat;
+	// Decode a sliding window around the playhead instead of the whole track, for sets too long to hold in memory.
+	// Also forced on by the controller's StreamTracksLongerThan. Streamed tracks can't bake or detect beats.
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	bool streamAnalysis;
+	// Analyze a submix as it plays (line-in, DJ sets routed through the mixer) instead of the track asset.
+	// Without an audio device the track asset, if set, is played into the input in its place.
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	bool analyzeLiveInput;
+	// Leave empty for the master submix
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (EditCondition = "analyzeLiveInput"))
+	USoundSubmix* liveSubmix;
+	// Finds onsets and beats once at arm time and fires them through the controller's OnOnset/OnBeat
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties")
+	bool detectBeats;
+	// Envelope and Peak response smoothing, in seconds so it looks the same at any frame rate
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (ClampMin = "0"))
+	float envelopeAttackTime;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (ClampMin = "0"))
+	float envelopeReleaseTime;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (ClampMin = "0"))
+	float peakHoldTime;
+	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties", meta = (ClampMin = "0"))
+	float peakReleaseTime;
 	UPROPERTY(EditAnywhere, Category = "Synth Visualization Track Properties Debug")
 	FColor trackColour;
 
@@ -39,12 +97,28 @@ public:
 	UPROPERTY(VisibleInstanceOnly, Category = "Synth Visualization Track Properties")
 	float maxFrequency;
 	UPROPERTY(VisibleInstanceOnly, Category = "Synth Visualization Track Properties")
-	TArray<float> spectrum;
-	UPROPERTY(VisibleInstanceOnly, Category = "Synth Visualization Track Properties")
 	USoundWave* trackInstance;
 
+	// Views into the controller's spectrum arena, empty until the controller activates the track
+	TArrayView<float> spectrum;
+	TArrayView<float> normalizedSpectrum;
+	TArrayView<float> envelopeSpectrum;
+	TArrayView<float> peakSpectrum;
+	TArrayView<float> peakHoldTimers;
+	int32 arenaOffset;
+	FDecodedPCMPtr pcm;
+	// Copied out of the wave by BeginArm, consumed by PrepareAnalysis
+	FSynthPCMDecodeSourcePtr pcmSource;
+	FSynthPCMStreamPtr pcmStream;
+	FSynthLiveInputPtr liveInput;
+	TSharedPtr<FSynthFileAudioSource, ESPMode::ThreadSafe> liveFileSource;
+	FSpectrumAnalyzer analyzer;
+	FSpectrogram spectrogram;
+	FBeatMap beatMap;
+	int32 workerSlot;
+
 	FTrackData();
-	bool operator== (FTrackData data)
+	bool operator== (const FTrackData& data) const
 	{
 		return (this->trackID == data.trackID);
 	}
@@ -54,11 +128,47 @@ public:
 		return isArmed;
 	}
 
+	// BeginArm, PrepareAnalysis and FinishArm back to back
 	void ArmTrack(AMusicController* musicController, USoundWave* masterTrack = nullptr);
+	// Game thread. Resolves the wave and sets up everything that touches UObjects or the audio device
+	bool BeginArm(AMusicController* musicController);
+	// Any thread. Decode, bake and beat detection, the expensive part of arming
+	bool PrepareAnalysis(AMusicController* musicController);
+	// Game thread
+	void FinishArm(AMusicController* musicController, USoundWave* masterTrack = nullptr);
+	void DisarmTrack();
+	// Two passes so every track's buffers land in a single allocation
+	void ReserveSpectrumBuffers(FSpectrumArena& arena);
+	void BindSpectrumBuffers(const FSpectrumArena& arena);
+	// Game thread, registers live tracks with their submix once the controller activates them
+	void StartLiveInput(AMusicController* musicController);
+	// Game thread, for tracks the controller analyzes itself. Builds the FFT tables and band matrix at activation,
+	// leaving the per update path with nothing to allocate.
+	void PrepareAnalyzer();
 	void UpdateSpectrum(AMusicController* musicController);
+	// Runs after every spectrum update, one pass over all bins for both the envelope and the peak hold
+	void UpdateEnvelopes(float DeltaTime);
 	float EvaluateRawFrequency(float frequencyNormalized);
 	float EvaluateClampedFrequency(float frequencyNormalized);
 	float EvaluateNormalizedFrequency(float frequencyNormalized);
+	void EvaluateNormalizedFrequencies(const float* frequenciesNormalized, int32 count, float* outValues);
+	void EvaluateNormalizedBars(int32 barCount, float* outValues);
+	float EvaluateSignal(ESynthResponseSignal signal, float frequencyNormalized);
+	void EvaluateSignals(ESynthResponseSignal signal, const float* frequenciesNormalized, int32 count, float* outValues);
+	SIZE_T GetSpectrumMemory() const;
+
+private:
+	// Drive the live update path directly, without a controller
+	friend class USynthAnalysisBenchmarkCommandlet;
+	friend class FSynthTrackNormalizationSpec;
+
+	// Clamp, normalize and power curve applied once per update, every query path reads normalizedSpectrum
+	void BuildNormalizedSpectrum();
+	void BuildBeatMap(AMusicController* musicController);
+	bool ArmLiveInput(AMusicController* musicController);
+	// Nearest band, or a blend of the two nearest when the layout interpolates
+	float SampleBands(TArrayView<const float> bands, float frequencyNormalized) const;
+	TArrayView<const float> GetSignalBands(ESynthResponseSignal signal) const;
 };
 
 USTRUCT(BlueprintType)
@@ -68,9 +178,9 @@ struct FSong
 
 public:
 
-	UPROPERTY()
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Synth Visualization Song")
 	FTrackData masterTrack;
-	UPROPERTY()
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Synth Visualization Song")
 	TArray<FTrackData> detailTracks;
 
 	FSong()
@@ -80,6 +190,25 @@ public:
 	}
 };
 
+// Responders of one class, updated back to back so the same update code stays hot
+USTRUCT()
+struct FMusicResponderGroup
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	UClass* responderClass;
+	UPROPERTY()
+	TArray<AMusicResponder*> responders;
+
+	FMusicResponderGroup()
+	{
+		responderClass = nullptr;
+		responders = TArray<AMusicResponder*>();
+	}
+};
+
 UCLASS(BlueprintType, Blueprintable)
 class SYNTHVISUALIZER_API AMusicController : public AActor
 {
@@ -96,10 +225,28 @@ public:
 	FMusicControllerEvent OnTrackEnd;
 	UPROPERTY(BlueprintAssignable)
 	FMusicControllerEvent OnTrackPaused;
+	UPROPERTY(BlueprintAssignable)
+	FMusicControllerRhythmEvent OnBeat;
+	UPROPERTY(BlueprintAssignable)
+	FMusicControllerRhythmEvent OnOnset;
+	// A song started with PrepareSong finished loading and analyzing in the background
+	UPROPERTY(BlueprintAssignable)
+	FMusicControllerEvent OnSongPrepared;
 
 	// Music Controller Blueprint
+	// Prepares the song in the background and switches to it as soon as it's ready
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	void ArmTrackTest(const FSong& trackData);
+	// Loads and analyzes a playlist song off the game thread, the current song keeps playing meanwhile
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	bool PrepareSong(int32 playlistIndex);
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
-	void ArmTrackTest(FSong trackData);
+	bool IsSongPrepared() const;
+	// Swaps the prepared song in, only costs the disarm of the current one
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	bool SwitchToPreparedSong(bool playSong = true, float fadeInDuration = 0.0f);
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	int32 GetCurrentSongIndex() const;
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
 	void PlayTrack(float startPercent = 0.0f, float fadeInDuration = 0.0f);
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
@@ -113,6 +260,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
 	float EvaluateNormalizedSpectrum(float normalizedFrequency, FName trackID);
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	void EvaluateNormalizedSpectrumBatch(const TArray<float>& normalizedFrequencies, FName trackID, TArray<float>& outValues);
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	void EvaluateNormalizedSpectrumBars(int32 barCount, FName trackID, TArray<float>& outValues);
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
 	float GetCurrentSongTime();
 	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
 	float GetCurrentSongPercent();
@@ -120,13 +271,28 @@ public:
 	float GetCurrentSongDuration();
 	UFUNCTION(Blueprintcallable, Category = "Synth Visualization Music Controller")
 	FString GetCurrentTrackTimeText();
+	UFUNCTION(BlueprintCallable, Category = "Synth Visualization Music Controller")
+	float GetTrackTempo(FName trackID);
 	UFUNCTION(BlueprintImplementableEvent)
-	TArray<float> CalculateFrequencySpectrum(USoundWave* track, float startTime, float timeLength, int32 spectrumResolution); // Currently have to do this in BP >:( because can't access SoundVisualizations library from c++ >:(    >:(    >:( 
+	TArray<float> CalculateFrequencySpectrum(USoundWave* track, float startTime, float timeLength, int32 spectrumResolution); // Optional override, only called if a BP implements it. Otherwise the native FSpectrumAnalyzer is used.
+	FORCEINLINE bool IsUsingBlueprintSpectrum() const { return useBlueprintSpectrum; }
+	FORCEINLINE FSpectrumAnalysisWorker* GetAnalysisWorker() const { return analysisWorker.Get(); }
+	// Song time shifted by the output latency, what spectrums and beat events are sampled at so they line up with what's audible
+	FORCEINLINE float GetSpectrumSampleTime() const { return songTime + AudioLatencyLookahead; }
+
+	// Handle based fast path, responses are resolved once and re-resolved only when the controller re-arms
+	bool ResolveTrackResponse(FTrackResponse& response) const;
+	float EvaluateTrackResponse(FTrackResponse& response);
+	void EvaluateTrackResponseBatch(FTrackResponse& response, const TArray<float>& normalizedFrequencies, TArray<float>& outValues);
+
+	// Registered responders are updated in one pass right after the spectrums, in place of their own actor ticks
+	void RegisterResponder(AMusicResponder* responder);
+	void UnregisterResponder(AMusicResponder* responder);
 
 	// Actor
 	virtual void Tick(float DeltaTime) override;
 	virtual void BeginDestroy() override;
-	//void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 protected:
 	// Called when the game starts or when spawned
@@ -135,9 +301,24 @@ protected:
 private:
 	void Initialize();
 	void ArmTrack();
+	// Builds the lookups, worker and stats from tracks that are already armed
+	void ActivateArmedTracks();
+	void StartAnalysisWorker();
 	void DisarmTrack();
 	void UpdateTrackState(float DeltaTime);
+	void UpdatePlaybackClock(float DeltaTime);
 	void UpdateFrequencySpectrums();
+	void UpdateSpectrumEnvelopes(float DeltaTime);
+	void UpdateResponders(float DeltaTime);
+	void UpdateMusicEvents();
+
+	// Playlist
+	bool BeginPreparingSong(const FSong& song, int32 playlistIndex, bool switchWhenReady);
+	void PrepareNextSong();
+	void StartPendingPreparation();
+	void UpdatePendingSong();
+	bool IsPendingSongCaching() const;
+	void CancelPendingSong();
 
 	UFUNCTION()
 	void UpdatePlaybackPercent(const USoundWave* playingSoundWave, const float playbackPercent);
@@ -151,9 +332,15 @@ private:
 	// Debugging
 	void DoDebugLogic();
 
+	// Drives the tick path directly for the allocation check
+	friend class FSynthTickAllocationTest;
+
 public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Music Controller")
 	UAudioComponent* AudioComponent;
+	// Responders with the same tag bind to this controller, leave as None for a single stage level
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Music Controller")
+	FName ControllerTag;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller")
 	FTrackData MasterTrack;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller")
@@ -162,6 +349,27 @@ public:
 	bool PlayOnStart;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller", meta = (EditCondition="PlayOnStart", ClampMin = "0", ClampMax = "1"))
 	float SongStartPercent;
+	UPROPERTY(EditAnywhere, Category = "Music Controller")
+	bool AnalyzeOnWorkerThread = true;
+	UPROPERTY(EditAnywhere, Category = "Music Controller", meta = (EditCondition = "AnalyzeOnWorkerThread", ClampMin = "10", ClampMax = "480"))
+	float WorkerAnalysisRate = 120.0f;
+	UPROPERTY(EditAnywhere, Category = "Music Controller")
+	bool ParallelTrackUpdates = true;
+	// Seconds to sample ahead of the playback clock to cover the audio device's output latency
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller", meta = (ClampMin = "-0.5", ClampMax = "0.5"))
+	float AudioLatencyLookahead = 0.0f;
+	// Tracks longer than this many seconds are streamed rather than decoded whole, 0 leaves it to each track's streamAnalysis
+	UPROPERTY(EditAnywhere, Category = "Music Controller", meta = (ClampMin = "0"))
+	float StreamTracksLongerThan = 600.0f;
+
+	// Songs played back to back. Used from the first entry when MasterTrack has no track
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller Playlist")
+	TArray<FSong> Playlist;
+	// Prepare the next song while the current one plays and switch over when it finishes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller Playlist")
+	bool AdvancePlaylist = true;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Music Controller Playlist", meta = (EditCondition = "AdvancePlaylist"))
+	bool LoopPlaylist = true;
 
 	UPROPERTY(EditAnywhere, Category = "Music Controller Debugging")
 	bool enableDebugging = false;
@@ -179,10 +387,49 @@ public:
 private:
 	bool isArmed;
 	bool isPlayingTrack;
+	bool useBlueprintSpectrum;
+	bool useParallelTrackUpdates;
+	// Set while a Stop() issued by StopTrack is still to come back through OnAudioFinished
+	bool audioStopRequested;
 	float songPercent;
 	float songTime;
 	float songDuration;
 	float initialAudioTime;
 	float initialPlaybackPercent;
+	float clockDrift;
 	TMap<FName, FTrackData*> trackMap;
+	TArray<FTrackData*> armedTracks;
+	uint32 trackGeneration;
+	// Reported to STAT_SynthSpectrumMemory while armed
+	SIZE_T spectrumMemory;
+	TUniquePtr<FSpectrumAnalysisWorker> analysisWorker;
+	// Band buffers of every armed track, reallocated only when the tracks are (re)activated
+	FSpectrumArena spectrumArena;
+	UPROPERTY()
+	TArray<FMusicResponderGroup> responderGroups;
+	// Unregistering during UpdateResponders nulls the entry, the pass compacts the groups once it's done
+	bool isUpdatingResponders;
+	bool hasUnregisteredResponders;
+
+	enum class EPendingSongState : uint8
+	{
+		None,
+		Loading,
+		// Waves loaded, waiting on editor spectrogram bakes so BeginArm doesn't block on them
+		Caching,
+		Preparing,
+		Ready
+	};
+
+	// Kept as a property so the loaded waves stay referenced until the switch
+	UPROPERTY()
+	FSong pendingSong;
+	EPendingSongState pendingState;
+	int32 pendingSongIndex;
+	int32 currentSongIndex;
+	bool switchWhenPrepared;
+	TSharedPtr<FStreamableHandle> pendingLoadHandle;
+	// One per pending track, invalid where arming already failed on the game thread
+	TArray<FTrackData*> pendingTracks;
+	TArray<TFuture<bool>> pendingTasks;
 };
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SynthResponseSignal.generated.h"
+
+// Which per track signal a responder reads, all three are built once per update by the controller
+UENUM(BlueprintType)
+enum class ESynthResponseSignal : uint8
+{
+	// Normalized spectrum as analyzed, no smoothing
+	Spectrum,
+	// Attack/release envelope of the normalized spectrum
+	Envelope,
+	// Peak hold of the normalized spectrum
+	Peak
+};
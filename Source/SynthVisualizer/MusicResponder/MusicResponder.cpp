@@ -2,8 +2,8 @@
 
 
 #include "MusicResponder.h"
-#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/MusicSubsystem/SynthMusicSubsystem.h"
 
 // Sets default values
 AMusicResponder::AMusicResponder()
@@ -17,26 +17,40 @@ AMusicResponder::AMusicResponder()
 void AMusicResponder::BeginPlay()
 {
 	Super::BeginPlay();
-	TArray<AActor*> musicControllers;
-	UGameplayStatics::GetAllActorsOfClass(this, AMusicController::StaticClass(), musicControllers);
 
-	if (musicControllers.Num() < 0)
+	USynthMusicSubsystem* musicSubsystem = USynthMusicSubsystem::Get(this);
+	if (musicSubsystem == nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Music Responder (%s): Failed to initializer. Couldn't find music controller."), *GetName());
+		UE_LOG(LogTemp, Warning, TEXT("Music Responder (%s): Failed to initialize. Couldn't find music subsystem."), *GetName());
 		SetActorTickEnabled(false);
+		return;
 	}
 
-	musicController = Cast<AMusicController>(musicControllers[0]);
-	if (musicController == nullptr)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Music Responder (%s): Failed to initializer. Failed to cast music controller?"), *GetName());
-		SetActorTickEnabled(false);
-	}
+	// Binds straight away if the controller is already playing, otherwise once it registers
+	musicSubsystem->RegisterResponder(this);
+}
 
+void AMusicResponder::BindToController(AMusicController* controller)
+{
+	musicController = controller;
 	musicController->OnTrackStart.AddDynamic(this, &AMusicResponder::OnTrackStart);
 	musicController->OnTrackEnd.AddDynamic(this, &AMusicResponder::OnTrackEnd);
 
 	InitializeMusicResponder();
+
+	// The controller drives the native update, so the actor tick is only kept for blueprints that use it
+	musicController->RegisterResponder(this);
+	if (!GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AMusicResponder, ReceiveTick)))
+	{
+		SetActorTickEnabled(false);
+	}
+
 	UE_LOG(LogTemp, Log, TEXT("Music Responder (%s): Initialized."), *GetName());
 }
 
+void AMusicResponder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USynthMusicSubsystem* musicSubsystem = USynthMusicSubsystem::Get(this)) musicSubsystem->UnregisterResponder(this);
+	if (musicController != nullptr && musicController->IsValidLowLevel()) musicController->UnregisterResponder(this);
+	Super::EndPlay(EndPlayReason);
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SynthVisualizer/MusicController/SynthResponseSignal.h"
 #include "MusicResponder.generated.h"
 
 class AMusicController;
@@ -18,11 +19,21 @@ public:
 	FName trackName;
 	UPROPERTY(EditAnywhere, Category = "Music Response", meta = (ClampMin="0", ClampMax="1"))
 	float frequencyTune;
+	// Defaults to the unsmoothed spectrum responders have always read, Envelope and Peak are opt in
+	UPROPERTY(EditAnywhere, Category = "Music Response")
+	ESynthResponseSignal signal;
+
+	// Resolved by AMusicController::ResolveTrackResponse, index into the controller's armed tracks
+	int32 trackHandle;
+	uint32 trackGeneration;
 
 	FTrackResponse()
 	{
 		trackName = FName("None");
 		frequencyTune = 0.0f;
+		signal = ESynthResponseSignal::Spectrum;
+		trackHandle = INDEX_NONE;
+		trackGeneration = 0;
 	}
 };
 
@@ -35,10 +46,16 @@ public:
 	// Sets default values for this actor's properties
 	AMusicResponder();
 
+	// Called by the music controller once per frame, right after the track spectrums update
+	virtual void UpdateMusicResponse(float DeltaTime) {};
+	// Called by USynthMusicSubsystem once the controller with a matching tag has begun play
+	void BindToController(AMusicController* controller);
+
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// Music Responder Interface
 	UFUNCTION()
@@ -49,6 +66,9 @@ protected:
 	virtual void OnTrackEnd() {};
 
 public:
+	// Tag of the controller to respond to, None uses the level's untagged controller
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Music Responder")
+	FName ControllerTag;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, Category = "Music Responder")
@@ -1,29 +1,49 @@
 #include "SpectrumBar.h"
 #include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/SynthVisualizer.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
 #include "Engine/World.h"
 
 ASpectrumBar::ASpectrumBar()
 {
-
+	// Plain ISM rather than HISM, the bars move every frame and HISM would rebuild its cluster tree each time
+	barInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(FName("Bar Instances"));
+	barInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BarMesh = nullptr;
+	BarMaterial = nullptr;
 }
 
-void ASpectrumBar::Tick(float DeltaTime)
+void ASpectrumBar::UpdateMusicResponse(float DeltaTime)
 {
-	if (bars.Num() <= 0) return;
+	if (barFrequencies.Num() <= 0) return;
+
+	musicController->EvaluateTrackResponseBatch(barResponse, barFrequencies, barValues);
+	if (UseInstancedBars)
+	{
+		UpdateBarInstances();
+		return;
+	}
 
 	for (int i = 0; i < bars.Num(); i++)
 	{
-		FSpectrumBarData data = bars[i];
-		AActor* bar = data.bar;
-		float frequencyIndex = data.frequencyIndex;
-		float frequency = musicController->EvaluateNormalizedSpectrum(frequencyIndex, TrackToRespondTo);
-		bar->SetActorScale3D(FVector(1.0f, 1.0f, (frequency / Divisor)));
+		bars[i].bar->SetActorScale3D(FVector(1.0f, 1.0f, (barValues[i] / Divisor)));
 	}
 }
 
 void ASpectrumBar::InitializeMusicResponder()
 {
-	SpawnBars();
+	barResponse.trackName = TrackToRespondTo;
+	musicController->ResolveTrackResponse(barResponse);
+
+	if (UseInstancedBars)
+	{
+		SpawnBarInstances();
+	}
+	else
+	{
+		SpawnBars();
+	}
 }
 
 void ASpectrumBar::SpawnBars()
@@ -39,7 +59,59 @@ void ASpectrumBar::SpawnBars()
 		AActor* barActor = world->SpawnActor <AActor>(BarTemplate, spawnLocation, spawnRotation, params);
 		//barActor = world->SpawnActor<AActor>(BarTemplate->StaticClass(), , FTransform())
 		//AActor* barActor = NewObject<AActor>(this, BarTemplate);// FString::Printf("Bar %d", i));
-		FSpectrumBarData barData = FSpectrumBarData(barActor, i / NumberOfBars);
+		FSpectrumBarData barData = FSpectrumBarData(barActor, (float)i / NumberOfBars);
 		bars.Add(barData);
+		barFrequencies.Add(barData.frequencyIndex);
+	}
+}
+
+void ASpectrumBar::SpawnBarInstances()
+{
+	if (BarMesh == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Spectrum Bar (%s): Can't draw instanced bars. Missing bar mesh."), *GetName());
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Spectrum Bar (%s): Adding %d bar instances..."), *GetName(), NumberOfBars);
+	barInstances->SetStaticMesh(BarMesh);
+	if (BarMaterial != nullptr) barInstances->SetMaterial(0, BarMaterial);
+	barInstances->NumCustomDataFloats = HeightFromCustomData ? 1 : 0;
+	barInstances->ClearInstances();
+
+	// Same layout as the actor bars, kept in world space so the bars don't depend on how the component is attached
+	barTransforms.Reset(NumberOfBars);
+	barFrequencies.Reset(NumberOfBars);
+	for (int i = 0; i < NumberOfBars; i++)
+	{
+		const FVector barLocation = GetActorLocation() + (FVector::ForwardVector * BarDistance * i);
+		barTransforms.Add(FTransform(GetActorRotation(), barLocation, FVector::OneVector));
+		barFrequencies.Add((float)i / NumberOfBars);
 	}
-}
\ No newline at end of file
+
+	barInstances->PreAllocateInstancesMemory(NumberOfBars);
+	for (const FTransform& barTransform : barTransforms) barInstances->AddInstanceWorldSpace(barTransform);
+}
+
+void ASpectrumBar::UpdateBarInstances()
+{
+	const int32 numInstances = FMath::Min(barTransforms.Num(), barInstances->GetInstanceCount());
+	if (numInstances <= 0) return;
+	SYNTH_VISUALIZER_SCOPE(BarInstances);
+
+	// Custom data leaves the transforms (and bounds) alone, only the last write marks the render state dirty
+	if (HeightFromCustomData)
+	{
+		for (int i = 0; i < numInstances; i++)
+		{
+			barInstances->SetCustomDataValue(i, 0, barValues[i] / Divisor, i == numInstances - 1);
+		}
+		return;
+	}
+
+	for (int i = 0; i < numInstances; i++)
+	{
+		barTransforms[i].SetScale3D(FVector(1.0f, 1.0f, barValues[i] / Divisor));
+	}
+	barInstances->BatchUpdateInstancesTransforms(0, barTransforms, true, true, false);
+}
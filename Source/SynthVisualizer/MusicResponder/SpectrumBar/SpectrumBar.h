@@ -4,6 +4,10 @@
 #include "SynthVisualizer/MusicResponder/MusicResponder.h"
 #include "SpectrumBar.generated.h"
 
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+class UMaterialInterface;
+
 USTRUCT()
 struct FSpectrumBarData
 {
@@ -36,17 +40,17 @@ public:
 	ASpectrumBar();
 
 public:
-	// Actor interface
-	virtual void Tick(float DeltaTime) override;
-	
 	// Spectrum Bar Interface
 	virtual void InitializeMusicResponder() override;
+	virtual void UpdateMusicResponse(float DeltaTime) override;
 
 protected:
 
 
 private:
 	void SpawnBars();
+	void SpawnBarInstances();
+	void UpdateBarInstances();
 
 public:
 
@@ -60,8 +64,26 @@ public:
 	float Divisor = 1.0f;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bar")
 	FName TrackToRespondTo;
+	// Draw every bar as an instance of one mesh instead of spawning a BarTemplate actor per bar
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bar Instancing")
+	bool UseInstancedBars = false;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bar Instancing", meta = (EditCondition = "UseInstancedBars"))
+	UStaticMesh* BarMesh;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bar Instancing", meta = (EditCondition = "UseInstancedBars"))
+	UMaterialInterface* BarMaterial;
+	// Write the bar height to per instance custom data 0 and leave the transforms alone, the material does the scaling
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bar Instancing", meta = (EditCondition = "UseInstancedBars"))
+	bool HeightFromCustomData = false;
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Spectrum Bar Instancing")
+	UInstancedStaticMeshComponent* barInstances;
 
 private:
 
+	FTrackResponse barResponse;
 	TArray<FSpectrumBarData> bars;
+	TArray<float> barFrequencies;
+	TArray<float> barValues;
+	TArray<FTransform> barTransforms;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Components/StaticMeshComponent.h"
 #include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/SynthVisualizer.h"
 
 ASynthSky::ASynthSky()
 {
@@ -16,11 +17,14 @@ ASynthSky::ASynthSky()
 void ASynthSky::InitializeMusicResponder()
 {
 	dynamicMaterial = skyMesh->CreateDynamicMaterialInstance(0, skyMesh->GetMaterial(0));
+	musicController->ResolveTrackResponse(BrightnessResponse);
 }
 
-void ASynthSky::Tick(float DeltaTime)
+void ASynthSky::UpdateMusicResponse(float DeltaTime)
 {
 	float currentNormalizedFrequency = 0.0f;
-	currentNormalizedFrequency = musicController->EvaluateNormalizedSpectrum(BrightnessResponse.frequencyTune, BrightnessResponse.trackName);
+	currentNormalizedFrequency = musicController->EvaluateTrackResponse(BrightnessResponse);
+
+	SYNTH_VISUALIZER_SCOPE(MaterialParameters);
 	dynamicMaterial->SetScalarParameterValue(SkyBrightnessParam, currentNormalizedFrequency);
 }
\ No newline at end of file
@@ -17,9 +17,7 @@ public:
 
 	// Music Responder
 	virtual void InitializeMusicResponder() override;
-
-	// Actor
-	virtual void Tick(float DeltaTime) override;
+	virtual void UpdateMusicResponse(float DeltaTime) override;
 
 private:
 
@@ -2,6 +2,7 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Components/StaticMeshComponent.h"
 #include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/SynthVisualizer.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 
 ASynthSun::ASynthSun()
@@ -27,14 +28,18 @@ void ASynthSun::InitializeMusicResponder()
 {
 	dynamicMaterial = sunMesh->CreateDynamicMaterialInstance(0, sunMesh->GetMaterial(0));
 	initialScale = GetActorScale().X;
+	musicController->ResolveTrackResponse(ScaleResponse);
+	musicController->ResolveTrackResponse(BrightnessResponse);
 }
 
-void ASynthSun::Tick(float DeltaTime)
+void ASynthSun::UpdateMusicResponse(float DeltaTime)
 {
-	float scaleSignal = musicController->EvaluateNormalizedSpectrum(ScaleResponse.frequencyTune, ScaleResponse.trackName);
+	float scaleSignal = musicController->EvaluateTrackResponse(ScaleResponse);
 	float scale = FMath::Lerp(initialScale, initialScale * maxScale, scaleSignal);
 	SetActorScale3D(FVector(scale, scale, scale));
 
-	float brightnessSignal = musicController->EvaluateNormalizedSpectrum(BrightnessResponse.frequencyTune, BrightnessResponse.trackName);
+	float brightnessSignal = musicController->EvaluateTrackResponse(BrightnessResponse);
+
+	SYNTH_VISUALIZER_SCOPE(MaterialParameters);
 	dynamicMaterial->SetScalarParameterValue("BrightnessSignal", brightnessSignal);
 }
\ No newline at end of file
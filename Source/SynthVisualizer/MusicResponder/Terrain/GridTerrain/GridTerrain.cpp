@@ -2,8 +2,15 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Components/StaticMeshComponent.h"
 #include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/SynthVisualizer.h"
 #include "Kismet/KismetMathLibrary.h"
 
+namespace
+{
+	// Frame rate PanSmoothLerp was tuned at
+	constexpr float PanSmoothReferenceRate = 60.0f;
+}
+
 AGridTerrain::AGridTerrain()
 {
 	terrainMesh = CreateDefaultSubobject<UStaticMeshComponent>(FName("Terrain Mesh"));
@@ -17,6 +24,10 @@ AGridTerrain::AGridTerrain()
 void AGridTerrain::InitializeMusicResponder()
 {
 	dynamicMaterial = terrainMesh->CreateDynamicMaterialInstance(0, terrainMesh->GetMaterial(0));
+	musicController->ResolveTrackResponse(BassResponse);
+	musicController->ResolveTrackResponse(LeadVerseResponse);
+	musicController->ResolveTrackResponse(LeadChorusResponse);
+	musicController->ResolveTrackResponse(OutroResponse);
 
 	FMaterialParameterInfo paramInfo = FMaterialParameterInfo("EmissiveBrightness");
 	dynamicMaterial->GetScalarParameterValue(paramInfo, initialBrightness);
@@ -39,7 +50,7 @@ void AGridTerrain::OnTrackStart()
 	SetActorLocation(UKismetMathLibrary::TransformLocation(Camera->GetTransform(), startPos));
 }
 
-void AGridTerrain::Tick(float DeltaTime)
+void AGridTerrain::UpdateMusicResponse(float DeltaTime)
 {
 	DoTerrainPanningLogic(DeltaTime);
 	UpdateTerrainMaterial();	
@@ -75,17 +86,21 @@ void AGridTerrain::DoTerrainPanningLogic(float DeltaTime)
 	float currentSongPercent = musicController->GetCurrentSongPercent();
 	FVector targetPositionLS = FMath::Lerp(InitialPositionRelativeToCamera, FinalPositionRelativeToCamera, currentSongPercent);
 	FVector targetPositionWS = UKismetMathLibrary::TransformLocation(Camera->GetTransform(), targetPositionLS);
-	FVector smoothPosition = FMath::Lerp(GetActorLocation(), targetPositionWS, PanSmoothLerp);
+	// PanSmoothLerp is tuned as a per frame blend at 60 fps, scaled to the real frame time so panning speed doesn't follow frame rate
+	const float panBlend = 1.0f - FMath::Pow(1.0f - FMath::Clamp(PanSmoothLerp, 0.0f, 1.0f), DeltaTime * PanSmoothReferenceRate);
+	FVector smoothPosition = FMath::Lerp(GetActorLocation(), targetPositionWS, panBlend);
 	SetActorLocation(smoothPosition);
 }
 
 
 void AGridTerrain::UpdateTerrainMaterial()
 {
-	float bassSignal = musicController->EvaluateNormalizedSpectrum(BassResponse.frequencyTune, BassResponse.trackName);
-	float verseSignal = musicController->EvaluateNormalizedSpectrum(LeadVerseResponse.frequencyTune, LeadVerseResponse.trackName);
-	float chorusSignal = musicController->EvaluateNormalizedSpectrum(LeadChorusResponse.frequencyTune, LeadChorusResponse.trackName);
-	float outroSignal = musicController->EvaluateNormalizedSpectrum(OutroResponse.frequencyTune, OutroResponse.trackName);
+	float bassSignal = musicController->EvaluateTrackResponse(BassResponse);
+	float verseSignal = musicController->EvaluateTrackResponse(LeadVerseResponse);
+	float chorusSignal = musicController->EvaluateTrackResponse(LeadChorusResponse);
+	float outroSignal = musicController->EvaluateTrackResponse(OutroResponse);
+
+	SYNTH_VISUALIZER_SCOPE(MaterialParameters);
 	dynamicMaterial->SetScalarParameterValue("BassSignal", bassSignal);
 	dynamicMaterial->SetScalarParameterValue("VerseSignal", verseSignal);
 	dynamicMaterial->SetScalarParameterValue("ChorusSignal", chorusSignal);
@@ -16,8 +16,8 @@ public:
 	AGridTerrain();
 
 
-	// Actor
-	virtual void Tick(float DeltaTime) override;
+	// Music Responder
+	virtual void UpdateMusicResponse(float DeltaTime) override;
 
 	// Blueprint
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Grin Terrain Panning")
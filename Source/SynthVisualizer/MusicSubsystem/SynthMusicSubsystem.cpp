@@ -0,0 +1,95 @@
+#include "SynthMusicSubsystem.h"
+#include "Engine/World.h"
+#include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/MusicResponder/MusicResponder.h"
+
+void USynthMusicSubsystem::Deinitialize()
+{
+	for (AMusicResponder* responder : pendingResponders)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Synth Music Subsystem: Responder (%s) never found a music controller tagged (%s)."), *responder->GetName(), *responder->ControllerTag.ToString());
+	}
+
+	controllers.Empty();
+	pendingResponders.Empty();
+	firstController = nullptr;
+	Super::Deinitialize();
+}
+
+USynthMusicSubsystem* USynthMusicSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject != nullptr ? worldContextObject->GetWorld() : nullptr;
+	return world != nullptr ? world->GetSubsystem<USynthMusicSubsystem>() : nullptr;
+}
+
+void USynthMusicSubsystem::RegisterController(AMusicController* controller)
+{
+	if (controller == nullptr) return;
+
+	if (AMusicController** existingController = controllers.Find(controller->ControllerTag))
+	{
+		if (*existingController != controller)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Synth Music Subsystem: Controller (%s) has the same tag (%s) as (%s), its responders will bind to (%s)."), *controller->GetName(), *controller->ControllerTag.ToString(), *(*existingController)->GetName(), *(*existingController)->GetName());
+		}
+		return;
+	}
+
+	controllers.Add(controller->ControllerTag, controller);
+	if (firstController == nullptr) firstController = controller;
+
+	// Responders that began play before this controller have been waiting for it
+	for (int i = pendingResponders.Num() - 1; i >= 0; i--)
+	{
+		AMusicResponder* responder = pendingResponders[i];
+		if (FindController(responder->ControllerTag) != controller) continue;
+
+		pendingResponders.RemoveAt(i);
+		responder->BindToController(controller);
+	}
+}
+
+void USynthMusicSubsystem::UnregisterController(AMusicController* controller)
+{
+	if (controller == nullptr) return;
+
+	AMusicController** registeredController = controllers.Find(controller->ControllerTag);
+	if (registeredController == nullptr || *registeredController != controller) return;
+
+	controllers.Remove(controller->ControllerTag);
+	if (firstController == controller)
+	{
+		firstController = nullptr;
+		for (const TPair<FName, AMusicController*>& pair : controllers)
+		{
+			firstController = pair.Value;
+			break;
+		}
+	}
+}
+
+void USynthMusicSubsystem::RegisterResponder(AMusicResponder* responder)
+{
+	if (responder == nullptr) return;
+
+	AMusicController* controller = FindController(responder->ControllerTag);
+	if (controller == nullptr)
+	{
+		pendingResponders.AddUnique(responder);
+		return;
+	}
+
+	responder->BindToController(controller);
+}
+
+void USynthMusicSubsystem::UnregisterResponder(AMusicResponder* responder)
+{
+	pendingResponders.Remove(responder);
+}
+
+AMusicController* USynthMusicSubsystem::FindController(FName controllerTag) const
+{
+	if (AMusicController* const* controller = controllers.Find(controllerTag)) return *controller;
+
+	return controllerTag.IsNone() ? firstController : nullptr;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SynthMusicSubsystem.generated.h"
+
+class AMusicController;
+class AMusicResponder;
+
+/**
+ * Per world registry of music controllers and responders.
+ * Controllers register under their ControllerTag and responders bind to the controller with the matching tag,
+ * waiting for it if it hasn't begun play yet, so several stages can run side by side in one level.
+ */
+UCLASS()
+class SYNTHVISUALIZER_API USynthMusicSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Subsystem
+	virtual void Deinitialize() override;
+
+	// Synth Music Subsystem
+	static USynthMusicSubsystem* Get(const UObject* worldContextObject);
+	void RegisterController(AMusicController* controller);
+	void UnregisterController(AMusicController* controller);
+	void RegisterResponder(AMusicResponder* responder);
+	void UnregisterResponder(AMusicResponder* responder);
+
+	// A None tag finds the untagged controller, or the first one registered if every controller is tagged
+	UFUNCTION(BlueprintCallable, Category = "Synth Music Subsystem")
+	AMusicController* FindController(FName controllerTag) const;
+
+private:
+	UPROPERTY()
+	TMap<FName, AMusicController*> controllers;
+	UPROPERTY()
+	AMusicController* firstController;
+	UPROPERTY()
+	TArray<AMusicResponder*> pendingResponders;
+};
@@ -0,0 +1,278 @@
+#include "SynthPCMCache.h"
+#include "Sound/SoundWave.h"
+#include "Audio.h"
+#include "AudioDevice.h"
+#include "AudioDecompress.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	constexpr uint32 PCMAlignment = 64;
+
+	TAutoConsoleVariable<int32> CVarPCMCacheMaxMB(
+		TEXT("SynthVisualizer.PCMCacheMaxMB"),
+		512,
+		TEXT("Soft cap on decoded PCM kept by the synth visualizer. Unreferenced waves are evicted least recently used first."));
+
+	FAutoConsoleCommand PCMCacheFlushCommand(
+		TEXT("SynthVisualizer.PCMCacheFlush"),
+		TEXT("Evicts every decoded wave no track is currently holding."),
+		FConsoleCommandDelegate::CreateLambda([]() { FSynthPCMCache::Get().EvictUnreferenced(); }));
+}
+
+FDecodedPCM::FDecodedPCM(ESynthPCMFormat inFormat, int32 inNumSamples, int32 inSampleRate)
+{
+	format = inFormat;
+	numSamples = inNumSamples;
+	sampleRate = inSampleRate;
+	data = FMemory::Malloc(GetAllocatedSize(), PCMAlignment);
+}
+
+FDecodedPCM::~FDecodedPCM()
+{
+	FMemory::Free(data);
+}
+
+SIZE_T FDecodedPCM::GetAllocatedSize() const
+{
+	return (SIZE_T)numSamples * (format == ESynthPCMFormat::Float ? sizeof(float) : sizeof(int16));
+}
+
+FSynthPCMCache& FSynthPCMCache::Get()
+{
+	static FSynthPCMCache cache;
+	return cache;
+}
+
+FSynthPCMDecodeSource::FSynthPCMDecodeSource()
+{
+	format = ESynthPCMFormat::Float;
+}
+
+FSynthPCMDecodeSource::~FSynthPCMDecodeSource()
+{
+}
+
+FDecodedPCMPtr FSynthPCMCache::Acquire(USoundWave* soundWave, ESynthPCMFormat format)
+{
+	FSynthPCMDecodeSourcePtr source = PrepareDecode(soundWave, format);
+	return source.IsValid() ? Acquire(*source) : nullptr;
+}
+
+FSynthPCMDecodeSourcePtr FSynthPCMCache::PrepareDecode(USoundWave* soundWave, ESynthPCMFormat format)
+{
+	if (soundWave == nullptr || !soundWave->IsValidLowLevel()) return nullptr;
+
+	FSynthPCMDecodeSourcePtr source = MakeShared<FSynthPCMDecodeSource, ESPMode::ThreadSafe>();
+	source->wave = FObjectKey(soundWave);
+	source->waveName = soundWave->GetName();
+	source->format = format;
+	{
+		// Held by the source so an eviction before the decode can't leave it with nothing to decode
+		FScopeLock scopeLock(&entriesLock);
+		if (FCacheEntry* entry = entries.Find(FCacheKey(soundWave, format)))
+		{
+			source->cachedPCM = entry->pcm;
+			return source;
+		}
+	}
+
+#if WITH_EDITORONLY_DATA
+	// Editor builds still have the imported wave file, so the PCM is read straight out of it
+	if (soundWave->RawData.GetBulkDataSize() > 0)
+	{
+		const uint8* rawWaveData = (const uint8*)soundWave->RawData.LockReadOnly();
+		source->waveFile.Append(rawWaveData, soundWave->RawData.GetBulkDataSize());
+		soundWave->RawData.Unlock();
+		return source;
+	}
+#endif
+
+	// Cooked builds only carry the compressed format, which the platform decoder expands later
+	FAudioDevice* audioDevice = GEngine ? GEngine->GetMainAudioDeviceRaw() : nullptr;
+	if (audioDevice == nullptr) return nullptr;
+
+	soundWave->InitAudioResource(audioDevice->GetRuntimeFormat(soundWave));
+	if (soundWave->ResourceData == nullptr || soundWave->ResourceSize <= 0) return nullptr;
+
+	source->compressedData.Append(soundWave->ResourceData, soundWave->ResourceSize);
+	source->audioInfo.Reset(audioDevice->CreateCompressedAudioInfo(soundWave));
+	return source->audioInfo.IsValid() ? source : nullptr;
+}
+
+FDecodedPCMPtr FSynthPCMCache::Acquire(const FSynthPCMDecodeSource& source)
+{
+	if (source.cachedPCM.IsValid()) return source.cachedPCM;
+
+	const FCacheKey key(source.wave, source.format);
+	{
+		FScopeLock scopeLock(&entriesLock);
+		if (FCacheEntry* entry = entries.Find(key))
+		{
+			entry->lastUsed = ++useCounter;
+			return entry->pcm;
+		}
+	}
+
+	// Decoding outside the lock keeps a background decode from stalling game thread lookups of cached waves
+	TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> pcm = Decode(source);
+	if (!pcm.IsValid()) return nullptr;
+
+	FScopeLock scopeLock(&entriesLock);
+	if (FCacheEntry* entry = entries.Find(key))
+	{
+		// Someone else decoded the same wave meanwhile, share theirs
+		entry->lastUsed = ++useCounter;
+		return entry->pcm;
+	}
+
+	FCacheEntry& entry = entries.Add(key);
+	entry.pcm = pcm;
+	entry.lastUsed = ++useCounter;
+	residentBytes += pcm->GetAllocatedSize();
+	TrimToMemoryCap();
+	return pcm;
+}
+
+void FSynthPCMCache::Evict(const USoundWave* soundWave)
+{
+	FScopeLock scopeLock(&entriesLock);
+	for (auto it = entries.CreateIterator(); it; ++it)
+	{
+		if (it.Key().wave != FObjectKey(soundWave)) continue;
+
+		// Anyone still holding the buffer keeps it alive, the cache just forgets about it
+		residentBytes -= it.Value().pcm->GetAllocatedSize();
+		it.RemoveCurrent();
+	}
+}
+
+void FSynthPCMCache::EvictUnreferenced()
+{
+	FScopeLock scopeLock(&entriesLock);
+	for (auto it = entries.CreateIterator(); it; ++it)
+	{
+		if (!it.Value().pcm.IsUnique()) continue;
+
+		residentBytes -= it.Value().pcm->GetAllocatedSize();
+		it.RemoveCurrent();
+	}
+}
+
+SIZE_T FSynthPCMCache::GetResidentBytes() const
+{
+	FScopeLock scopeLock(&entriesLock);
+	return residentBytes;
+}
+
+void FSynthPCMCache::TrimToMemoryCap()
+{
+	const SIZE_T memoryCap = (SIZE_T)FMath::Max(0, CVarPCMCacheMaxMB.GetValueOnAnyThread()) * 1024 * 1024;
+	while (residentBytes > memoryCap)
+	{
+		const FCacheKey* oldestKey = nullptr;
+		uint64 oldestUse = MAX_uint64;
+		for (const TPair<FCacheKey, FCacheEntry>& pair : entries)
+		{
+			if (pair.Value.pcm.IsUnique() && pair.Value.lastUsed < oldestUse)
+			{
+				oldestKey = &pair.Key;
+				oldestUse = pair.Value.lastUsed;
+			}
+		}
+
+		if (oldestKey == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Synth PCM Cache: %llu bytes resident is over the cap but every wave is in use."), (uint64)residentBytes);
+			return;
+		}
+
+		const FCacheKey keyToEvict = *oldestKey;
+		residentBytes -= entries[keyToEvict].pcm->GetAllocatedSize();
+		entries.Remove(keyToEvict);
+	}
+}
+
+TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> FSynthPCMCache::Decode(const FSynthPCMDecodeSource& source)
+{
+	TArray<uint8> pcmData;
+	int32 numChannels = 0;
+	int32 sampleRate = 0;
+
+	FWaveModInfo waveInfo;
+	if (source.waveFile.Num() > 0)
+	{
+		if (waveInfo.ReadWaveInfo(source.waveFile.GetData(), source.waveFile.Num()) && *waveInfo.pBitsPerSample == 16)
+		{
+			pcmData.Append(waveInfo.SampleDataStart, waveInfo.SampleDataSize);
+			numChannels = *waveInfo.pChannels;
+			sampleRate = *waveInfo.pSamplesPerSec;
+		}
+	}
+	else if (source.audioInfo.IsValid())
+	{
+		FSoundQualityInfo qualityInfo;
+		if (source.audioInfo->ReadCompressedInfo(source.compressedData.GetData(), source.compressedData.Num(), &qualityInfo))
+		{
+			pcmData.SetNumUninitialized(qualityInfo.SampleDataSize);
+			source.audioInfo->ExpandFile(pcmData.GetData(), &qualityInfo);
+			numChannels = qualityInfo.NumChannels;
+			sampleRate = qualityInfo.SampleRate;
+		}
+	}
+
+	if (pcmData.Num() == 0 || numChannels <= 0 || sampleRate <= 0) return nullptr;
+
+	const int32 numFrames = pcmData.Num() / (sizeof(int16) * numChannels);
+	TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> pcm = MixDown((const int16*)pcmData.GetData(), numFrames, numChannels, sampleRate, source.format);
+
+	UE_LOG(LogTemp, Log, TEXT("Synth PCM Cache: Decoded (%s), %d samples at %d Hz."), *source.waveName, numFrames, sampleRate);
+	return pcm;
+}
+
+FDecodedPCMPtr FSynthPCMCache::DecodeWaveFile(const uint8* waveData, int32 waveDataSize, ESynthPCMFormat format)
+{
+	FWaveModInfo waveInfo;
+	if (waveData == nullptr || !waveInfo.ReadWaveInfo(waveData, waveDataSize) || *waveInfo.pBitsPerSample != 16) return nullptr;
+
+	const int32 numChannels = *waveInfo.pChannels;
+	const int32 sampleRate = *waveInfo.pSamplesPerSec;
+	if (numChannels <= 0 || sampleRate <= 0) return nullptr;
+
+	// The sample data isn't guaranteed to be 2 byte aligned inside the file, so copy it out first
+	TArray<int16> pcmSamples;
+	pcmSamples.SetNumUninitialized(waveInfo.SampleDataSize / sizeof(int16));
+	FMemory::Memcpy(pcmSamples.GetData(), waveInfo.SampleDataStart, pcmSamples.Num() * sizeof(int16));
+	return MixDown(pcmSamples.GetData(), pcmSamples.Num() / numChannels, numChannels, sampleRate, format);
+}
+
+TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> FSynthPCMCache::MixDown(const int16* pcmSamples, int32 numFrames, int32 numChannels, int32 sampleRate, ESynthPCMFormat format)
+{
+	// Mix down to mono, the spectrum is always analyzed across all channels together
+	TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> pcm = MakeShared<FDecodedPCM, ESPMode::ThreadSafe>(format, numFrames, sampleRate);
+
+	if (format == ESynthPCMFormat::Float)
+	{
+		float* samples = (float*)pcm->GetMutableData();
+		const float frameScale = 1.0f / (32768.0f * numChannels);
+		for (int i = 0; i < numFrames; i++)
+		{
+			int32 frameSum = 0;
+			for (int channel = 0; channel < numChannels; channel++) frameSum += pcmSamples[i * numChannels + channel];
+			samples[i] = frameSum * frameScale;
+		}
+	}
+	else
+	{
+		int16* samples = (int16*)pcm->GetMutableData();
+		for (int i = 0; i < numFrames; i++)
+		{
+			int32 frameSum = 0;
+			for (int channel = 0; channel < numChannels; channel++) frameSum += pcmSamples[i * numChannels + channel];
+			samples[i] = (int16)(frameSum / numChannels);
+		}
+	}
+
+	return pcm;
+}
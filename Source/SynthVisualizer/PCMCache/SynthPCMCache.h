@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "SynthPCMCache.generated.h"
+
+class USoundWave;
+class ICompressedAudioInfo;
+
+UENUM(BlueprintType)
+enum class ESynthPCMFormat : uint8
+{
+	Float,
+	Int16
+};
+
+/**
+ * Mono PCM decoded from a sound wave, stored in one contiguous 64 byte aligned buffer.
+ * Float samples are normalized to [-1, 1], int16 samples keep their native scale.
+ */
+struct SYNTHVISUALIZER_API FDecodedPCM
+{
+public:
+	ESynthPCMFormat format;
+	int32 numSamples;
+	int32 sampleRate;
+
+	FDecodedPCM(ESynthPCMFormat inFormat, int32 inNumSamples, int32 inSampleRate);
+	~FDecodedPCM();
+
+	FORCEINLINE const float* GetFloatData() const { return format == ESynthPCMFormat::Float ? (const float*)data : nullptr; }
+	FORCEINLINE const int16* GetInt16Data() const { return format == ESynthPCMFormat::Int16 ? (const int16*)data : nullptr; }
+	FORCEINLINE void* GetMutableData() { return data; }
+	FORCEINLINE float GetDuration() const { return sampleRate > 0 ? (float)numSamples / sampleRate : 0.0f; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	FDecodedPCM(const FDecodedPCM&) = delete;
+	FDecodedPCM& operator=(const FDecodedPCM&) = delete;
+
+	void* data;
+};
+
+typedef TSharedPtr<const FDecodedPCM, ESPMode::ThreadSafe> FDecodedPCMPtr;
+
+/**
+ * What a decode needs, copied out of the wave on the game thread so the decode itself never touches the wave's
+ * bulk data. A wave that was already cached when it was prepared just holds on to the cached PCM instead.
+ */
+struct SYNTHVISUALIZER_API FSynthPCMDecodeSource
+{
+public:
+	FObjectKey wave;
+	FString waveName;
+	ESynthPCMFormat format;
+	FDecodedPCMPtr cachedPCM;
+	// Editor builds, the imported .wav image
+	TArray<uint8> waveFile;
+	// Cooked builds, the runtime format payload and the decoder for it
+	TArray<uint8> compressedData;
+	TUniquePtr<ICompressedAudioInfo> audioInfo;
+
+	FSynthPCMDecodeSource();
+	~FSynthPCMDecodeSource();
+};
+
+typedef TSharedPtr<FSynthPCMDecodeSource, ESPMode::ThreadSafe> FSynthPCMDecodeSourcePtr;
+
+/**
+ * Process wide cache of decoded sound waves so every FTrackData referencing the same wave shares one decode.
+ * Entries are reference counted through FDecodedPCMPtr; only entries nobody holds anymore are evicted,
+ * either explicitly or when the cache grows past SynthVisualizer.PCMCacheMaxMB.
+ */
+class SYNTHVISUALIZER_API FSynthPCMCache
+{
+public:
+	static FSynthPCMCache& Get();
+
+	// Game thread, PrepareDecode and Acquire back to back
+	FDecodedPCMPtr Acquire(USoundWave* soundWave, ESynthPCMFormat format = ESynthPCMFormat::Float);
+	// Game thread. Copies the wave's payload out, unless it's already cached, so the decode can run elsewhere
+	FSynthPCMDecodeSourcePtr PrepareDecode(USoundWave* soundWave, ESynthPCMFormat format = ESynthPCMFormat::Float);
+	// Any thread
+	FDecodedPCMPtr Acquire(const FSynthPCMDecodeSource& source);
+	void Evict(const USoundWave* soundWave);
+	void EvictUnreferenced();
+	SIZE_T GetResidentBytes() const;
+
+	// Uncached decode of a 16 bit .wav file image, for tools that work on files rather than assets
+	static FDecodedPCMPtr DecodeWaveFile(const uint8* waveData, int32 waveDataSize, ESynthPCMFormat format = ESynthPCMFormat::Float);
+
+private:
+	struct FCacheKey
+	{
+		FObjectKey wave;
+		ESynthPCMFormat format;
+
+		FCacheKey(const USoundWave* inWave, ESynthPCMFormat inFormat) : wave(inWave), format(inFormat) {}
+		FCacheKey(FObjectKey inWave, ESynthPCMFormat inFormat) : wave(inWave), format(inFormat) {}
+		bool operator==(const FCacheKey& other) const { return wave == other.wave && format == other.format; }
+		friend uint32 GetTypeHash(const FCacheKey& key) { return HashCombine(GetTypeHash(key.wave), (uint32)key.format); }
+	};
+
+	struct FCacheEntry
+	{
+		TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> pcm;
+		uint64 lastUsed;
+	};
+
+	static TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> Decode(const FSynthPCMDecodeSource& source);
+	static TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> MixDown(const int16* pcmSamples, int32 numFrames, int32 numChannels, int32 sampleRate, ESynthPCMFormat format);
+	void TrimToMemoryCap();
+
+	TMap<FCacheKey, FCacheEntry> entries;
+	mutable FCriticalSection entriesLock;
+	SIZE_T residentBytes = 0;
+	uint64 useCounter = 0;
+};
@@ -0,0 +1,276 @@
+#include "SynthPCMStream.h"
+#include "Sound/SoundWave.h"
+#include "Audio.h"
+#include "AudioDevice.h"
+#include "AudioDecompress.h"
+#include "Engine/Engine.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	constexpr uint32 ChunkAlignment = 64;
+
+	TAutoConsoleVariable<float> CVarStreamChunkSeconds(
+		TEXT("SynthVisualizer.StreamChunkSeconds"),
+		2.0f,
+		TEXT("Length of each decoded chunk for streamed tracks. Read when a track is armed."));
+
+	TAutoConsoleVariable<int32> CVarStreamChunksAhead(
+		TEXT("SynthVisualizer.StreamChunksAhead"),
+		2,
+		TEXT("Chunks a streamed track keeps decoded ahead of the playhead. Read when a track is armed."));
+
+	TAutoConsoleVariable<int32> CVarStreamChunksBehind(
+		TEXT("SynthVisualizer.StreamChunksBehind"),
+		1,
+		TEXT("Chunks a streamed track keeps behind the playhead, so analysis windows reaching back don't miss. Read when a track is armed."));
+}
+
+TSharedPtr<FSynthPCMStream, ESPMode::ThreadSafe> FSynthPCMStream::Open(USoundWave* soundWave)
+{
+	if (soundWave == nullptr || !soundWave->IsValidLowLevel()) return nullptr;
+
+	TSharedPtr<FSynthPCMStream, ESPMode::ThreadSafe> stream = MakeShareable(new FSynthPCMStream());
+	if (!stream->Initialize(soundWave)) return nullptr;
+
+	UE_LOG(LogTemp, Log, TEXT("Synth PCM Stream: Streaming (%s), %lld samples at %d Hz through %d chunks of %d samples (%llu bytes, %d compressed)."),
+		*soundWave->GetName(), stream->numSamples, stream->sampleRate, stream->chunks.Num(), stream->chunkFrames, (uint64)stream->GetAllocatedSize(), stream->compressedData.Num());
+	return stream;
+}
+
+FSynthPCMStream::FSynthPCMStream()
+{
+	audioInfo = nullptr;
+	numChannels = 0;
+	sampleRate = 0;
+	numSamples = 0;
+	numChunks = 0;
+	chunkFrames = 0;
+	chunksAhead = 0;
+	chunksBehind = 0;
+	chunkMemory = nullptr;
+	nextSequentialChunk = 0;
+	thread = nullptr;
+	wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	playheadChunk = 0;
+	stopRequested = false;
+}
+
+FSynthPCMStream::~FSynthPCMStream()
+{
+	if (thread != nullptr)
+	{
+		thread->Kill(true);
+		delete thread;
+		thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+	wakeEvent = nullptr;
+	delete audioInfo;
+	FMemory::Free(chunkMemory);
+}
+
+bool FSynthPCMStream::Initialize(USoundWave* soundWave)
+{
+	// Same decoder the cache uses for cooked waves, but driven a chunk at a time instead of expanding the whole file
+	FAudioDevice* audioDevice = GEngine ? GEngine->GetMainAudioDeviceRaw() : nullptr;
+	if (audioDevice == nullptr) return false;
+
+	// Copied like FSynthPCMDecodeSource does, the wave's resource isn't ours to pin for the life of the stream
+	soundWave->InitAudioResource(audioDevice->GetRuntimeFormat(soundWave));
+	if (soundWave->ResourceData == nullptr || soundWave->ResourceSize <= 0) return false;
+	compressedData.Append(soundWave->ResourceData, soundWave->ResourceSize);
+
+	audioInfo = audioDevice->CreateCompressedAudioInfo(soundWave);
+	if (audioInfo == nullptr) return false;
+
+	FSoundQualityInfo qualityInfo;
+	if (!audioInfo->ReadCompressedInfo(compressedData.GetData(), compressedData.Num(), &qualityInfo)) return false;
+
+	numChannels = qualityInfo.NumChannels;
+	sampleRate = qualityInfo.SampleRate;
+	if (numChannels <= 0 || sampleRate <= 0) return false;
+
+	// Duration rather than SampleDataSize, the byte count is 32 bit and wraps for very long sets
+	numSamples = (int64)((double)qualityInfo.Duration * sampleRate);
+	chunkFrames = FMath::Max(1024, FMath::RoundToInt(FMath::Max(0.1f, CVarStreamChunkSeconds.GetValueOnAnyThread()) * sampleRate));
+	numChunks = (numSamples + chunkFrames - 1) / chunkFrames;
+	chunksAhead = FMath::Max(1, CVarStreamChunksAhead.GetValueOnAnyThread());
+	chunksBehind = FMath::Max(0, CVarStreamChunksBehind.GetValueOnAnyThread());
+	if (numSamples <= 0) return false;
+
+	const int32 numSlots = chunksBehind + 1 + chunksAhead;
+	chunkMemory = (float*)FMemory::Malloc((SIZE_T)numSlots * chunkFrames * sizeof(float), ChunkAlignment);
+	chunks.SetNum(numSlots);
+	for (int32 slot = 0; slot < numSlots; slot++)
+	{
+		chunks[slot].chunkIndex = INDEX_NONE;
+		chunks[slot].isReady = false;
+		chunks[slot].samples = chunkMemory + (SIZE_T)slot * chunkFrames;
+	}
+	decodeBuffer.SetNumUninitialized(chunkFrames * numChannels);
+
+	thread = FRunnableThread::Create(this, TEXT("SynthPCMStream"), 0, TPri_AboveNormal);
+	return thread != nullptr;
+}
+
+SIZE_T FSynthPCMStream::GetAllocatedSize() const
+{
+	return (SIZE_T)chunks.Num() * chunkFrames * sizeof(float) + decodeBuffer.GetAllocatedSize() + compressedData.GetAllocatedSize();
+}
+
+void FSynthPCMStream::SetPlayhead(float time)
+{
+	const int64 chunk = FMath::Clamp<int64>((int64)((double)time * sampleRate) / FMath::Max(1, chunkFrames), 0, FMath::Max<int64>(0, numChunks - 1));
+	if (playheadChunk.exchange(chunk) != chunk) wakeEvent->Trigger();
+}
+
+bool FSynthPCMStream::CopySamples(int64 firstSample, int32 count, float* outSamples)
+{
+	if (count <= 0) return true;
+
+	const int64 centreSample = FMath::Clamp<int64>(firstSample + count / 2, 0, FMath::Max<int64>(0, numSamples - 1));
+	const int64 centreChunk = centreSample / chunkFrames;
+	if (playheadChunk.exchange(centreChunk) != centreChunk) wakeEvent->Trigger();
+
+	bool isComplete = true;
+	FScopeLock scopeLock(&chunksLock);
+	for (int32 written = 0; written < count;)
+	{
+		const int64 sample = firstSample + written;
+		if (sample < 0 || sample >= numSamples)
+		{
+			const int32 silentRun = sample < 0 ? (int32)FMath::Min<int64>(count - written, -sample) : count - written;
+			FMemory::Memzero(outSamples + written, silentRun * sizeof(float));
+			written += silentRun;
+			continue;
+		}
+
+		const int64 chunkIndex = sample / chunkFrames;
+		const int32 chunkOffset = (int32)(sample - chunkIndex * chunkFrames);
+		const int32 run = (int32)FMath::Min<int64>(FMath::Min(count - written, chunkFrames - chunkOffset), numSamples - sample);
+
+		const FChunk* chunk = chunks.FindByPredicate([chunkIndex](const FChunk& candidate) { return candidate.chunkIndex == chunkIndex && candidate.isReady; });
+		if (chunk != nullptr)
+		{
+			FMemory::Memcpy(outSamples + written, chunk->samples + chunkOffset, run * sizeof(float));
+		}
+		else
+		{
+			FMemory::Memzero(outSamples + written, run * sizeof(float));
+			isComplete = false;
+		}
+		written += run;
+	}
+
+	return isComplete;
+}
+
+uint32 FSynthPCMStream::Run()
+{
+	while (!stopRequested)
+	{
+		const int64 centreChunk = playheadChunk;
+		int64 chunkIndex = INDEX_NONE;
+		int32 slot = INDEX_NONE;
+		{
+			// Only this thread claims slots, so a claimed slot can be decoded into without holding the lock
+			FScopeLock scopeLock(&chunksLock);
+			chunkIndex = FindChunkToDecode(centreChunk);
+			if (chunkIndex != INDEX_NONE) slot = ClaimChunkSlot(centreChunk);
+			if (slot != INDEX_NONE)
+			{
+				chunks[slot].chunkIndex = chunkIndex;
+				chunks[slot].isReady = false;
+			}
+		}
+
+		if (slot == INDEX_NONE)
+		{
+			wakeEvent->Wait();
+			continue;
+		}
+
+		DecodeChunk(chunkIndex, chunks[slot].samples);
+
+		FScopeLock scopeLock(&chunksLock);
+		chunks[slot].isReady = true;
+	}
+
+	return 0;
+}
+
+void FSynthPCMStream::Stop()
+{
+	stopRequested = true;
+	wakeEvent->Trigger();
+}
+
+void FSynthPCMStream::DecodeChunk(int64 chunkIndex, float* outSamples)
+{
+	// Decoding runs forward, only a jump (seek or the window moving backwards) needs the decoder repositioned
+	if (chunkIndex != nextSequentialChunk)
+	{
+		audioInfo->SeekToTime((float)((double)chunkIndex * chunkFrames / sampleRate));
+	}
+	nextSequentialChunk = chunkIndex + 1;
+
+	const int32 numFrames = (int32)FMath::Min<int64>(chunkFrames, numSamples - chunkIndex * chunkFrames);
+	audioInfo->ReadCompressedData((uint8*)decodeBuffer.GetData(), false, numFrames * numChannels * sizeof(int16));
+
+	// Mix down to mono the same way the cache does
+	const int16* pcmSamples = decodeBuffer.GetData();
+	const float frameScale = 1.0f / (32768.0f * numChannels);
+	for (int i = 0; i < numFrames; i++)
+	{
+		int32 frameSum = 0;
+		for (int channel = 0; channel < numChannels; channel++) frameSum += pcmSamples[i * numChannels + channel];
+		outSamples[i] = frameSum * frameScale;
+	}
+	if (numFrames < chunkFrames) FMemory::Memzero(outSamples + numFrames, (chunkFrames - numFrames) * sizeof(float));
+}
+
+int64 FSynthPCMStream::FindChunkToDecode(int64 centreChunk) const
+{
+	auto isResident = [this](int64 chunkIndex)
+	{
+		return chunks.ContainsByPredicate([chunkIndex](const FChunk& chunk) { return chunk.chunkIndex == chunkIndex; });
+	};
+
+	// The playhead chunk, then prefetch forwards, then back fill behind
+	for (int64 offset = 0; offset <= chunksAhead; offset++)
+	{
+		const int64 chunkIndex = centreChunk + offset;
+		if (chunkIndex < numChunks && !isResident(chunkIndex)) return chunkIndex;
+	}
+	for (int64 offset = 1; offset <= chunksBehind; offset++)
+	{
+		const int64 chunkIndex = centreChunk - offset;
+		if (chunkIndex >= 0 && !isResident(chunkIndex)) return chunkIndex;
+	}
+	return INDEX_NONE;
+}
+
+int32 FSynthPCMStream::ClaimChunkSlot(int64 centreChunk)
+{
+	// A free slot, otherwise whichever chunk has fallen furthest outside the window
+	int32 bestSlot = INDEX_NONE;
+	int64 bestDistance = 0;
+	for (int32 slot = 0; slot < chunks.Num(); slot++)
+	{
+		const int64 chunkIndex = chunks[slot].chunkIndex;
+		if (chunkIndex == INDEX_NONE) return slot;
+
+		const int64 distance = chunkIndex < centreChunk ? centreChunk - chunkIndex - chunksBehind : chunkIndex - centreChunk - chunksAhead;
+		if (distance > bestDistance)
+		{
+			bestDistance = distance;
+			bestSlot = slot;
+		}
+	}
+	return bestSlot;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class USoundWave;
+class ICompressedAudioInfo;
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Bounded memory mono PCM for tracks too long to decode whole (hour long sets and the like).
+ * The wave is decoded in fixed size chunks on the stream's own thread into a small pool of chunk buffers,
+ * keeping a sliding window around the playhead: SynthVisualizer.StreamChunksBehind chunks behind it,
+ * SynthVisualizer.StreamChunksAhead prefetched ahead. Decoded memory depends on the window, not the track length.
+ * That bound covers the decoded chunks only: the stream keeps its own copy of the compressed file resident for the
+ * decoder to read from, so the wave's resource can be released or reloaded underneath it.
+ */
+class SYNTHVISUALIZER_API FSynthPCMStream : public FRunnable
+{
+public:
+	static TSharedPtr<FSynthPCMStream, ESPMode::ThreadSafe> Open(USoundWave* soundWave);
+	virtual ~FSynthPCMStream();
+
+	FORCEINLINE int64 GetNumSamples() const { return numSamples; }
+	FORCEINLINE int32 GetSampleRate() const { return sampleRate; }
+	FORCEINLINE float GetDuration() const { return sampleRate > 0 ? (float)((double)numSamples / sampleRate) : 0.0f; }
+	// Decoded chunk pool plus the resident compressed file
+	SIZE_T GetAllocatedSize() const;
+
+	// Any thread. Moves the decode window, a seek wakes the stream thread straight away
+	void SetPlayhead(float time);
+	// Any thread. Zero fills past either end of the track and any part of the range that isn't decoded yet,
+	// returns false in the latter case. Reading also moves the playhead to the range.
+	bool CopySamples(int64 firstSample, int32 count, float* outSamples);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FChunk
+	{
+		int64 chunkIndex;
+		bool isReady;
+		float* samples;
+	};
+
+	FSynthPCMStream();
+	bool Initialize(USoundWave* soundWave);
+	void DecodeChunk(int64 chunkIndex, float* outSamples);
+	// Next chunk in the window that isn't resident, nearest the playhead first, INDEX_NONE when the window is full
+	int64 FindChunkToDecode(int64 centreChunk) const;
+	int32 ClaimChunkSlot(int64 centreChunk);
+
+	// The decoder reads straight out of this, it has to outlive audioInfo
+	TArray<uint8> compressedData;
+	ICompressedAudioInfo* audioInfo;
+	int32 numChannels;
+	int32 sampleRate;
+	int64 numSamples;
+	int64 numChunks;
+	int32 chunkFrames;
+	int32 chunksAhead;
+	int32 chunksBehind;
+
+	// Every chunk buffer lives in one allocation made at open, slots are recycled as the window moves
+	float* chunkMemory;
+	TArray<FChunk> chunks;
+	mutable FCriticalSection chunksLock;
+
+	// Stream thread only
+	TArray<int16> decodeBuffer;
+	int64 nextSequentialChunk;
+
+	FRunnableThread* thread;
+	FEvent* wakeEvent;
+	std::atomic<int64> playheadChunk;
+	std::atomic<bool> stopRequested;
+};
+
+typedef TSharedPtr<FSynthPCMStream, ESPMode::ThreadSafe> FSynthPCMStreamPtr;
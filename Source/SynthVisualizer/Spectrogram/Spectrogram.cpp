@@ -0,0 +1,157 @@
+#include "Spectrogram.h"
+#include "Async/ParallelFor.h"
+#include "SynthDSP/Quantize.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include "SynthVisualizer/SynthVisualizer.h"
+
+namespace
+{
+	constexpr int32 FramesPerBakeChunk = 256;
+
+	// UInt8 frames lead with their dequantize scale and offset
+	struct FUInt8FrameHeader
+	{
+		float scale;
+		float offset;
+	};
+}
+
+FSpectrogram::FSpectrogram()
+{
+	numFrames = 0;
+	numBins = 0;
+	frameRate = 0.0f;
+	format = ESynthSpectrogramFormat::Float;
+	frameStride = 0;
+	externalFrames = nullptr;
+}
+
+void FSpectrogram::Reset()
+{
+	numFrames = 0;
+	numBins = 0;
+	frameRate = 0.0f;
+	format = ESynthSpectrogramFormat::Float;
+	frameStride = 0;
+	frames.Empty();
+	externalFrames = nullptr;
+}
+
+void FSpectrogram::SetExternalFrames(const uint8* inFrames, int32 inNumFrames, int32 inNumBins, float inFrameRate, ESynthSpectrogramFormat inFormat)
+{
+	Reset();
+	if (inFrames == nullptr) return;
+
+	externalFrames = inFrames;
+	numFrames = inNumFrames;
+	numBins = inNumBins;
+	frameRate = inFrameRate;
+	format = inFormat;
+	frameStride = GetFrameStride(format, numBins);
+}
+
+int32 FSpectrogram::GetFrameIndex(float time) const
+{
+	return FMath::Clamp(FMath::FloorToInt(time * frameRate), 0, numFrames - 1);
+}
+
+void FSpectrogram::ReadFrame(int32 frameIndex, float* outBins) const
+{
+	const uint8* frame = GetFrameData(frameIndex);
+	switch (format)
+	{
+	case ESynthSpectrogramFormat::Half:
+		SynthDSP::DequantizeHalf((const uint16*)frame, numBins, outBins);
+		break;
+	case ESynthSpectrogramFormat::UInt8:
+	{
+		// Mapped cooked payloads start wherever the bulk data landed in the file, so the header may not be float aligned
+		FUInt8FrameHeader header;
+		FMemory::Memcpy(&header, frame, sizeof(header));
+		SynthDSP::DequantizeUInt8(frame + sizeof(FUInt8FrameHeader), numBins, header.scale, header.offset, outBins);
+		break;
+	}
+	default:
+		FMemory::Memcpy(outBins, frame, numBins * sizeof(float));
+		break;
+	}
+}
+
+void FSpectrogram::Compact(ESynthSpectrogramFormat inFormat)
+{
+	if (inFormat == format || externalFrames != nullptr || !IsValid()) return;
+
+	// Through float so any format converts to any other
+	const int32 newStride = GetFrameStride(inFormat, numBins);
+	TArray<uint8> newFrames;
+	newFrames.SetNumZeroed(numFrames * newStride);
+	TArray<float> frameBins;
+	frameBins.SetNumUninitialized(numBins);
+	for (int32 frame = 0; frame < numFrames; frame++)
+	{
+		ReadFrame(frame, frameBins.GetData());
+		uint8* target = newFrames.GetData() + (int64)frame * newStride;
+		switch (inFormat)
+		{
+		case ESynthSpectrogramFormat::Half:
+			SynthDSP::QuantizeHalf(frameBins.GetData(), numBins, (uint16*)target);
+			break;
+		case ESynthSpectrogramFormat::UInt8:
+		{
+			FUInt8FrameHeader* header = (FUInt8FrameHeader*)target;
+			SynthDSP::QuantizeUInt8(frameBins.GetData(), numBins, target + sizeof(FUInt8FrameHeader), header->scale, header->offset);
+			break;
+		}
+		default:
+			FMemory::Memcpy(target, frameBins.GetData(), numBins * sizeof(float));
+			break;
+		}
+	}
+
+	frames = MoveTemp(newFrames);
+	format = inFormat;
+	frameStride = newStride;
+}
+
+int32 FSpectrogram::GetFrameStride(ESynthSpectrogramFormat inFormat, int32 inNumBins)
+{
+	switch (inFormat)
+	{
+	case ESynthSpectrogramFormat::Half:
+		return Align(inNumBins * (int32)sizeof(uint16), 4);
+	case ESynthSpectrogramFormat::UInt8:
+		return (int32)sizeof(FUInt8FrameHeader) + Align(inNumBins, 4);
+	default:
+		return inNumBins * (int32)sizeof(float);
+	}
+}
+
+void FSpectrogram::Bake(const FDecodedPCM& pcm, float timeSlice, int32 spectrumResolution, ESpectrumWindowType windowType, const FSpectrumBandLayout& bandLayout, float frameRate, FSpectrogram& outSpectrogram)
+{
+	outSpectrogram.Reset();
+	if (pcm.numSamples <= 0 || pcm.sampleRate <= 0 || spectrumResolution <= 0 || frameRate <= 0.0f) return;
+	SYNTH_VISUALIZER_SCOPE(SpectrogramBake);
+
+	const float duration = pcm.GetDuration();
+	outSpectrogram.frameRate = frameRate;
+	outSpectrogram.numBins = spectrumResolution;
+	outSpectrogram.numFrames = FMath::Max(1, FMath::CeilToInt(duration * frameRate));
+	outSpectrogram.format = ESynthSpectrogramFormat::Float;
+	outSpectrogram.frameStride = GetFrameStride(ESynthSpectrogramFormat::Float, spectrumResolution);
+	outSpectrogram.frames.SetNumUninitialized(outSpectrogram.numFrames * outSpectrogram.frameStride);
+
+	// Split the song into time chunks, each chunk gets its own analyzer so no scratch is shared between tasks
+	const int32 numChunks = FMath::DivideAndRoundUp(outSpectrogram.numFrames, FramesPerBakeChunk);
+	ParallelFor(numChunks, [&](int32 chunkIndex)
+	{
+		FSpectrumAnalyzer chunkAnalyzer;
+		chunkAnalyzer.SetBandLayout(bandLayout);
+		const int32 firstFrame = chunkIndex * FramesPerBakeChunk;
+		const int32 lastFrame = FMath::Min(firstFrame + FramesPerBakeChunk, outSpectrogram.numFrames);
+		for (int32 frame = firstFrame; frame < lastFrame; frame++)
+		{
+			float* frameSpectrum = (float*)(outSpectrogram.frames.GetData() + (int64)frame * outSpectrogram.frameStride);
+			chunkAnalyzer.CalculateFrequencySpectrum(pcm, frame / frameRate, timeSlice, spectrumResolution, windowType, TArrayView<float>(frameSpectrum, spectrumResolution));
+		}
+	});
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "Spectrogram.generated.h"
+
+// Per bin storage of a spectrogram frame. Compact formats are dequantized as frames are read
+UENUM(BlueprintType)
+enum class ESynthSpectrogramFormat : uint8
+{
+	Float,
+	// Half precision dB, 2 bytes a bin
+	Half,
+	// 8 bit dB codes over each frame's own range (per frame scale and offset), about 1 byte a bin
+	UInt8
+};
+
+/**
+ * Dense, frame indexed spectrum of a whole track baked at arm time.
+ * Frame i holds the spectrum for a window starting at i / frameRate seconds.
+ * Frames are a fixed stride apart in one byte buffer whatever the format, so owned and mapped storage read the same way.
+ */
+struct SYNTHVISUALIZER_API FSpectrogram
+{
+public:
+	int32 numFrames;
+	int32 numBins;
+	float frameRate;
+	ESynthSpectrogramFormat format;
+	int32 frameStride;
+	TArray<uint8> frames;
+	// Frames owned by someone else (e.g. a memory mapped USynthSpectrogramAsset), takes precedence over frames
+	const uint8* externalFrames;
+
+	FSpectrogram();
+
+	void Reset();
+	void SetExternalFrames(const uint8* inFrames, int32 inNumFrames, int32 inNumBins, float inFrameRate, ESynthSpectrogramFormat inFormat = ESynthSpectrogramFormat::Float);
+	bool IsValid() const { return numFrames > 0 && numBins > 0; }
+	int32 GetFrameIndex(float time) const;
+	FORCEINLINE const uint8* GetFrameData(int32 frameIndex) const { return (externalFrames != nullptr ? externalFrames : frames.GetData()) + (int64)frameIndex * frameStride; }
+	// numBins dB values, dequantized straight into outBins
+	void ReadFrame(int32 frameIndex, float* outBins) const;
+	// Re-encodes owned frames in place, external frames are left alone
+	void Compact(ESynthSpectrogramFormat inFormat);
+
+	// Bytes a frame of numBins takes, padded so every frame starts 4 byte aligned
+	static int32 GetFrameStride(ESynthSpectrogramFormat inFormat, int32 inNumBins);
+	static void Bake(const FDecodedPCM& pcm, float timeSlice, int32 spectrumResolution, ESpectrumWindowType windowType, const FSpectrumBandLayout& bandLayout, float frameRate, FSpectrogram& outSpectrogram);
+};
@@ -0,0 +1,222 @@
+#include "SynthSpectrogramAsset.h"
+#include "Sound/SoundWave.h"
+#include "HAL/PlatformFilemanager.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include "Async/Async.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+
+// Bump this whenever the analysis output changes so stale DDC entries are ignored
+#define SYNTH_SPECTROGRAM_DERIVEDDATA_VER TEXT("6B1E0C2A9D7F4E3B8A5C1D2E3F405162")
+#endif
+
+USynthSpectrogramAsset::USynthSpectrogramAsset()
+{
+	sourceWave = nullptr;
+	spectrumResolution = 64;
+	spectrumTimeSlice = 0.1f;
+	spectrumClamp = 60.0f;
+	spectrumWindow = ESpectrumWindowType::Hann;
+	frameRate = 60.0f;
+	storageFormat = ESynthSpectrogramFormat::Float;
+	numFrames = 0;
+	frameFormat = ESynthSpectrogramFormat::Float;
+	mappedFrames = nullptr;
+	isBulkDataLocked = false;
+#if WITH_EDITOR
+	pendingFormat = ESynthSpectrogramFormat::Float;
+#endif
+
+	// Keep the frames out of the export so they can be mapped straight from the bulk file
+	frameData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+}
+
+void USynthSpectrogramAsset::Serialize(FArchive& Ar)
+{
+#if WITH_EDITOR
+	// Land any finished bake before the tagged properties are written so numFrames/sourceGuid match the payload.
+	// The cooker has already waited on it through IsCachedCookedPlatformDataLoaded.
+	if (Ar.IsSaving() && Ar.IsPersistent())
+	{
+		FinishCaching();
+	}
+#endif
+
+	Super::Serialize(Ar);
+	frameData.Serialize(Ar, this);
+}
+
+void USynthSpectrogramAsset::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITOR
+	// Only starts a bake if the saved frames are stale, the result is picked up when a track arms with this asset
+	BeginCacheSpectrogram();
+#endif
+}
+
+void USynthSpectrogramAsset::BeginDestroy()
+{
+	UnmapFrames();
+	Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void USynthSpectrogramAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BeginCacheSpectrogram(true);
+}
+
+void USynthSpectrogramAsset::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+	BeginCacheSpectrogram();
+}
+
+bool USynthSpectrogramAsset::IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform)
+{
+	return !pendingFrames.IsValid() || pendingFrames.IsReady();
+}
+
+void USynthSpectrogramAsset::BeginCacheSpectrogram(bool forceRebuild)
+{
+	if (sourceWave == nullptr || spectrumResolution <= 0) return;
+	if (!forceRebuild && frameData.GetBulkDataSize() > 0 && sourceGuid == sourceWave->CompressedDataGuid && numFrames > 0 && frameFormat == storageFormat) return;
+
+	// A bake for the same source and settings is already on its way
+	if (!forceRebuild && pendingFrames.IsValid() && pendingSourceGuid == sourceWave->CompressedDataGuid && pendingFormat == storageFormat) return;
+
+	// Wave payloads aren't safe to read off the game thread, copy it out here and decode on the pool
+	FSynthPCMDecodeSourcePtr pcmSource = FSynthPCMCache::Get().PrepareDecode(sourceWave);
+	if (!pcmSource.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to build spectrogram. Couldn't read sound wave (%s)."), *GetName(), *sourceWave->GetName());
+		return;
+	}
+
+	pendingSourceGuid = sourceWave->CompressedDataGuid;
+	pendingFormat = storageFormat;
+
+	// Everything the bake reads is captured by value so edits made while it runs can't reach it, they start their own
+	const FString derivedDataKey = GetDerivedDataKey();
+	const FString assetName = GetName();
+	const FSpectrumBandLayout layout = bandLayout;
+	const float timeSlice = spectrumTimeSlice;
+	const int32 resolution = spectrumResolution;
+	const ESpectrumWindowType window = spectrumWindow;
+	const float rate = frameRate;
+	const float clamp = spectrumClamp;
+	const ESynthSpectrogramFormat format = storageFormat;
+	pendingFrames = Async(EAsyncExecution::ThreadPool, [derivedDataKey, assetName, pcmSource, layout, timeSlice, resolution, window, rate, clamp, format]()
+	{
+		TArray<uint8> derivedData;
+		if (GetDerivedDataCacheRef().GetSynchronous(*derivedDataKey, derivedData)) return derivedData;
+
+		FDecodedPCMPtr pcm = FSynthPCMCache::Get().Acquire(*pcmSource);
+		if (!pcm.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("(%s): Failed to build spectrogram. Couldn't decode sound wave (%s)."), *assetName, *(pcmSource->waveName));
+			return derivedData;
+		}
+
+		FSpectrogram spectrogram;
+		FSpectrogram::Bake(*pcm, timeSlice, resolution, window, layout, rate, spectrogram);
+		float* values = (float*)spectrogram.frames.GetData();
+		for (int32 i = 0; i < spectrogram.numFrames * spectrogram.numBins; i++) values[i] = FMath::Clamp(values[i], -clamp, clamp);
+		spectrogram.Compact(format);
+
+		derivedData.Append(spectrogram.frames);
+		GetDerivedDataCacheRef().Put(*derivedDataKey, derivedData);
+		UE_LOG(LogTemp, Log, TEXT("(%s): Built spectrogram (%d frames)."), *assetName, spectrogram.numFrames);
+		return derivedData;
+	});
+}
+
+FString USynthSpectrogramAsset::GetDerivedDataKey() const
+{
+	const FString keySuffix = FString::Printf(TEXT("%s_%d_%.4f_%.2f_%d_%.2f_%s_%d"), *sourceWave->CompressedDataGuid.ToString(), spectrumResolution, spectrumTimeSlice, spectrumClamp, (int32)spectrumWindow, frameRate, *bandLayout.ToKeyString(), (int32)storageFormat);
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("SYNTHSPECTROGRAM"), SYNTH_SPECTROGRAM_DERIVEDDATA_VER, *keySuffix);
+}
+#endif
+
+void USynthSpectrogramAsset::FinishCaching()
+{
+#if WITH_EDITOR
+	if (!pendingFrames.IsValid()) return;
+
+	TArray<uint8> derivedData = pendingFrames.Get();
+	pendingFrames.Reset();
+	if (derivedData.Num() == 0) return;
+
+	UnmapFrames();
+	numFrames = derivedData.Num() / FSpectrogram::GetFrameStride(pendingFormat, spectrumResolution);
+	frameFormat = pendingFormat;
+	sourceGuid = pendingSourceGuid;
+
+	frameData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(frameData.Realloc(derivedData.Num()), derivedData.GetData(), derivedData.Num());
+	frameData.Unlock();
+#endif
+}
+
+bool USynthSpectrogramAsset::IsCaching() const
+{
+#if WITH_EDITOR
+	return pendingFrames.IsValid() && !pendingFrames.IsReady();
+#else
+	return false;
+#endif
+}
+
+bool USynthSpectrogramAsset::MatchesTrack(const USoundWave* wave, int32 resolution, float timeSlice, float clamp, ESpectrumWindowType window, const FSpectrumBandLayout& layout) const
+{
+	if (wave == nullptr || wave != sourceWave || numFrames <= 0) return false;
+
+	return sourceGuid == wave->CompressedDataGuid
+		&& spectrumResolution == resolution
+		&& spectrumWindow == window
+		&& bandLayout == layout
+		&& FMath::IsNearlyEqual(spectrumTimeSlice, timeSlice)
+		&& FMath::IsNearlyEqual(spectrumClamp, clamp);
+}
+
+const uint8* USynthSpectrogramAsset::MapFrames()
+{
+	if (mappedFrames != nullptr) return mappedFrames;
+	if (frameData.GetBulkDataSize() <= 0) return nullptr;
+
+	// Cooked payloads sit uncompressed in their own file, so map just that region and let the OS page it in on demand
+	if (!frameData.IsBulkDataLoaded() && !frameData.IsStoredCompressedOnDisk() && frameData.GetBulkDataOffsetInFile() >= 0)
+	{
+		mappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*frameData.GetFilename()));
+		if (mappedHandle.IsValid())
+		{
+			mappedRegion.Reset(mappedHandle->MapRegion(frameData.GetBulkDataOffsetInFile(), frameData.GetBulkDataSize()));
+		}
+
+		if (mappedRegion.IsValid())
+		{
+			mappedFrames = mappedRegion->GetMappedPtr();
+			return mappedFrames;
+		}
+
+		mappedHandle.Reset();
+		UE_LOG(LogTemp, Log, TEXT("(%s): Couldn't memory map spectrogram, loading it instead."), *GetName());
+	}
+
+	mappedFrames = (const uint8*)frameData.LockReadOnly();
+	isBulkDataLocked = true;
+	return mappedFrames;
+}
+
+void USynthSpectrogramAsset::UnmapFrames()
+{
+	if (isBulkDataLocked) frameData.Unlock();
+	isBulkDataLocked = false;
+	mappedRegion.Reset();
+	mappedHandle.Reset();
+	mappedFrames = nullptr;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Serialization/BulkData.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/Future.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+#include "SynthSpectrogramAsset.generated.h"
+
+class USoundWave;
+
+/**
+ * Spectrogram of a sound wave generated at cook time (or pulled from the DDC in the editor).
+ * Frame data lives in a separate bulk data payload that is memory mapped on load,
+ * so arming a track with one of these does no DSP and only touched pages become resident.
+ * Bakes run on the thread pool, the cooker waits on them through the cooked platform data calls.
+ */
+UCLASS(BlueprintType)
+class SYNTHVISUALIZER_API USynthSpectrogramAsset : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	USynthSpectrogramAsset();
+
+	// UObject
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+	virtual bool IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform) override;
+#endif
+
+	// Spectrogram Asset
+	// Game thread, applies a bake still running in the editor and blocks until it's done. Does nothing in cooked builds.
+	void FinishCaching();
+	// An editor bake is still running, FinishCaching would block. Always false in cooked builds.
+	bool IsCaching() const;
+	bool MatchesTrack(const USoundWave* wave, int32 resolution, float timeSlice, float clamp, ESpectrumWindowType window, const FSpectrumBandLayout& layout) const;
+	const uint8* MapFrames();
+	FORCEINLINE int32 GetNumFrames() const { return numFrames; }
+	FORCEINLINE ESynthSpectrogramFormat GetFrameFormat() const { return frameFormat; }
+
+private:
+#if WITH_EDITOR
+	void BeginCacheSpectrogram(bool forceRebuild = false);
+	FString GetDerivedDataKey() const;
+#endif
+	void UnmapFrames();
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	USoundWave* sourceWave;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	int32 spectrumResolution;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	float spectrumTimeSlice;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	float spectrumClamp;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	ESpectrumWindowType spectrumWindow;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	FSpectrumBandLayout bandLayout;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram", meta = (ClampMin = "1", ClampMax = "240"))
+	float frameRate;
+	// Half or UInt8 cut the payload to a half or about a quarter, the track dequantizes each frame as it's read
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Synth Spectrogram")
+	ESynthSpectrogramFormat storageFormat;
+
+	UPROPERTY(VisibleAnywhere, Category = "Synth Spectrogram")
+	FGuid sourceGuid;
+	UPROPERTY(VisibleAnywhere, Category = "Synth Spectrogram")
+	int32 numFrames;
+	// Format the payload was actually built in
+	UPROPERTY(VisibleAnywhere, Category = "Synth Spectrogram")
+	ESynthSpectrogramFormat frameFormat;
+
+private:
+	FByteBulkData frameData;
+	TUniquePtr<IMappedFileHandle> mappedHandle;
+	TUniquePtr<IMappedFileRegion> mappedRegion;
+	const uint8* mappedFrames;
+	bool isBulkDataLocked;
+
+#if WITH_EDITOR
+	// Frames from the DDC or a fresh bake, empty if the wave couldn't be decoded
+	TFuture<TArray<uint8>> pendingFrames;
+	FGuid pendingSourceGuid;
+	ESynthSpectrogramFormat pendingFormat;
+#endif
+};
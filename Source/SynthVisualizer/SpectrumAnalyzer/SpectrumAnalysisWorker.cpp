@@ -0,0 +1,107 @@
+#include "SpectrumAnalysisWorker.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "SynthVisualizer/SynthVisualizer.h"
+
+FSpectrumAnalysisWorker::FSpectrumAnalysisWorker(float inAnalysisRate)
+{
+	thread = nullptr;
+	wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	analysisInterval = 1.0f / FMath::Max(1.0f, inAnalysisRate);
+	songStartWallTime = FPlatformTime::Seconds();
+	isPlayingTrack = false;
+	stopRequested = false;
+}
+
+FSpectrumAnalysisWorker::~FSpectrumAnalysisWorker()
+{
+	if (thread != nullptr)
+	{
+		thread->Kill(true);
+		delete thread;
+		thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+	wakeEvent = nullptr;
+}
+
+int32 FSpectrumAnalysisWorker::AddTrack(const FDecodedPCMPtr& pcm, int32 spectrumResolution, float spectrumTimeSlice, ESpectrumWindowType spectrumWindow, const FSpectrumBandLayout& bandLayout)
+{
+	if (thread != nullptr || !pcm.IsValid()) return INDEX_NONE;
+
+	// Every buffer is sized up front so publishing never allocates
+	TArray<float> initialSpectrum;
+	initialSpectrum.Init(0.0f, spectrumResolution);
+
+	TUniquePtr<FWorkerTrack> track = MakeUnique<FWorkerTrack>(initialSpectrum);
+	track->pcm = pcm;
+	track->spectrumResolution = spectrumResolution;
+	track->spectrumTimeSlice = spectrumTimeSlice;
+	track->spectrumWindow = spectrumWindow;
+	track->analyzer.SetBandLayout(bandLayout);
+	track->analyzer.PrepareFraming(pcm->sampleRate, spectrumTimeSlice, spectrumResolution, spectrumWindow, false);
+	return tracks.Add(MoveTemp(track));
+}
+
+void FSpectrumAnalysisWorker::Start()
+{
+	if (thread != nullptr || tracks.Num() == 0) return;
+	thread = FRunnableThread::Create(this, TEXT("SynthSpectrumAnalysis"), 0, TPri_AboveNormal);
+}
+
+void FSpectrumAnalysisWorker::SetPlaybackClock(float songTime, bool isPlaying)
+{
+	songStartWallTime = FPlatformTime::Seconds() - songTime;
+	if (isPlayingTrack.exchange(isPlaying) != isPlaying && isPlaying) wakeEvent->Trigger();
+}
+
+bool FSpectrumAnalysisWorker::ReadSpectrum(int32 trackSlot, TArrayView<float> outSpectrum)
+{
+	if (!tracks.IsValidIndex(trackSlot)) return false;
+
+	TTripleBuffer<TArray<float>>& spectrumBuffer = tracks[trackSlot]->spectrumBuffer;
+	if (!spectrumBuffer.IsDirty()) return false;
+
+	spectrumBuffer.SwapReadBuffers();
+	const TArray<float>& latestSpectrum = spectrumBuffer.Read();
+	FMemory::Memcpy(outSpectrum.GetData(), latestSpectrum.GetData(), FMath::Min(outSpectrum.Num(), latestSpectrum.Num()) * sizeof(float));
+	return true;
+}
+
+uint32 FSpectrumAnalysisWorker::Run()
+{
+	while (!stopRequested)
+	{
+		const double frameStart = FPlatformTime::Seconds();
+		if (!isPlayingTrack)
+		{
+			wakeEvent->Wait();
+			continue;
+		}
+
+		// Analyze one interval ahead so the frame is ready by the time the game thread reads it
+		const float predictedSongTime = (float)(frameStart - songStartWallTime + analysisInterval);
+		{
+			SYNTH_VISUALIZER_SCOPE(WorkerAnalysis);
+			for (TUniquePtr<FWorkerTrack>& track : tracks)
+			{
+				TArray<float>& writeBuffer = track->spectrumBuffer.GetWriteBuffer();
+				track->analyzer.CalculateFrequencySpectrum(*track->pcm, predictedSongTime, track->spectrumTimeSlice, track->spectrumResolution, track->spectrumWindow, writeBuffer);
+				track->spectrumBuffer.SwapWriteBuffers();
+			}
+		}
+
+		const double remainingTime = analysisInterval - (FPlatformTime::Seconds() - frameStart);
+		if (remainingTime > 0.0) wakeEvent->Wait(FTimespan::FromSeconds(remainingTime));
+	}
+
+	return 0;
+}
+
+void FSpectrumAnalysisWorker::Stop()
+{
+	stopRequested = true;
+	wakeEvent->Trigger();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/TripleBuffer.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Runs live spectrum analysis off the game thread. The worker extrapolates the song clock
+ * published by the controller, analyzes every registered track slightly ahead of it and
+ * publishes each result through a lock free triple buffer, so the game thread always reads
+ * the latest complete frame without waiting on the analysis.
+ */
+class SYNTHVISUALIZER_API FSpectrumAnalysisWorker : public FRunnable
+{
+public:
+	FSpectrumAnalysisWorker(float inAnalysisRate);
+	virtual ~FSpectrumAnalysisWorker();
+
+	// Tracks can only be added before Start
+	int32 AddTrack(const FDecodedPCMPtr& pcm, int32 spectrumResolution, float spectrumTimeSlice, ESpectrumWindowType spectrumWindow, const FSpectrumBandLayout& bandLayout);
+	void Start();
+
+	// Game thread
+	void SetPlaybackClock(float songTime, bool isPlaying);
+	// Copies into the caller's buffer, which is already sized to the track's resolution
+	bool ReadSpectrum(int32 trackSlot, TArrayView<float> outSpectrum);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FWorkerTrack
+	{
+		FDecodedPCMPtr pcm;
+		FSpectrumAnalyzer analyzer;
+		int32 spectrumResolution;
+		float spectrumTimeSlice;
+		ESpectrumWindowType spectrumWindow;
+		TTripleBuffer<TArray<float>> spectrumBuffer;
+
+		FWorkerTrack(const TArray<float>& initialSpectrum) : spectrumBuffer(initialSpectrum) {}
+	};
+
+	TArray<TUniquePtr<FWorkerTrack>> tracks;
+	FRunnableThread* thread;
+	FEvent* wakeEvent;
+	float analysisInterval;
+
+	// Song time is published as the wall clock time the song started at, so the clock is a single atomic
+	std::atomic<double> songStartWallTime;
+	std::atomic<bool> isPlayingTrack;
+	std::atomic<bool> stopRequested;
+};
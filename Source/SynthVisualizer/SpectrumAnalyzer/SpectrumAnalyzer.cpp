@@ -0,0 +1,170 @@
+#include "SpectrumAnalyzer.h"
+#include "SynthDSP/SpectrumMath.h"
+#include "SynthDSP/Window.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+#include "SynthVisualizer/PCMCache/SynthPCMStream.h"
+
+namespace
+{
+	// Matches the int16 sample scale the SoundVisualizations FFT worked in, so dB output lines up with old spectrumClamp values
+	constexpr float PCMSampleScale = 32768.0f;
+	constexpr float DecibelScale = 4.342944819f; // 10 / ln(10)
+	constexpr float MinimumPower = 1.0e-12f;
+	constexpr int32 MinimumFFTSize = 64;
+}
+
+FSpectrumAnalyzer::FSpectrumAnalyzer()
+{
+	fftSize = 0;
+	windowType = ESpectrumWindowType::Rectangular;
+}
+
+void FSpectrumAnalyzer::SetBandLayout(const FSpectrumBandLayout& inBandLayout)
+{
+	if (inBandLayout == bandLayout) return;
+	bandLayout = inBandLayout;
+	bandMatrix.Reset();
+}
+
+void FSpectrumAnalyzer::PrepareFraming(int32 sampleRate, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, bool isStreamed)
+{
+	if (sampleRate <= 0 || spectrumResolution <= 0) return;
+
+	Prepare(GetFFTSize(sampleRate, timeLength), inWindowType);
+	if (!bandMatrix.IsBuilt(spectrumResolution, fftSize, sampleRate)) bandMatrix.Build(bandLayout, spectrumResolution, fftSize, sampleRate);
+	if (isStreamed && streamFrame.Num() != fftSize) streamFrame.SetNumUninitialized(fftSize);
+}
+
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(const FDecodedPCM& pcm, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, TArrayView<float> outSpectrum)
+{
+	check(outSpectrum.Num() >= spectrumResolution);
+	if (pcm.format == ESynthPCMFormat::Int16)
+	{
+		CalculateFrequencySpectrum(pcm.GetInt16Data(), 1.0f / PCMSampleScale, pcm.numSamples, pcm.sampleRate, startTime, timeLength, spectrumResolution, inWindowType, outSpectrum.GetData());
+	}
+	else
+	{
+		CalculateFrequencySpectrum(pcm.GetFloatData(), 1.0f, pcm.numSamples, pcm.sampleRate, startTime, timeLength, spectrumResolution, inWindowType, outSpectrum.GetData());
+	}
+}
+
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(const float* samples, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, TArrayView<float> outSpectrum)
+{
+	check(outSpectrum.Num() >= spectrumResolution);
+	CalculateFrequencySpectrum(samples, 1.0f, numSamples, sampleRate, startTime, timeLength, spectrumResolution, inWindowType, outSpectrum.GetData());
+}
+
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(const FDecodedPCM& pcm, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, TArray<float>& outSpectrum)
+{
+	if (spectrumResolution <= 0) return;
+	if (outSpectrum.Num() != spectrumResolution) outSpectrum.SetNumUninitialized(spectrumResolution);
+	CalculateFrequencySpectrum(pcm, startTime, timeLength, spectrumResolution, inWindowType, TArrayView<float>(outSpectrum));
+}
+
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(const float* samples, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, TArray<float>& outSpectrum)
+{
+	if (spectrumResolution <= 0) return;
+	if (outSpectrum.Num() != spectrumResolution) outSpectrum.SetNumUninitialized(spectrumResolution);
+	CalculateFrequencySpectrum(samples, numSamples, sampleRate, startTime, timeLength, spectrumResolution, inWindowType, TArrayView<float>(outSpectrum));
+}
+
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(FSynthPCMStream& stream, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, TArrayView<float> outSpectrum)
+{
+	if (spectrumResolution <= 0) return;
+	check(outSpectrum.Num() >= spectrumResolution);
+
+	if (stream.GetNumSamples() <= 0 || stream.GetSampleRate() <= 0)
+	{
+		WriteSilence(spectrumResolution, outSpectrum.GetData());
+		return;
+	}
+
+	const int64 firstSample = PrepareFrame(stream.GetNumSamples(), stream.GetSampleRate(), startTime, timeLength, inWindowType);
+
+	// The stream can't hand out a pointer into its window, so the frame is copied out first
+	if (streamFrame.Num() != fftSize) streamFrame.SetNumUninitialized(fftSize);
+	stream.CopySamples(firstSample, fftSize, streamFrame.GetData());
+
+	fft.LoadFrame(streamFrame.GetData(), fftSize, 1.0f, window.GetData());
+	fft.Forward();
+	fft.PowerSpectrum(power.GetData());
+	BucketPowerSpectrum(stream.GetSampleRate(), spectrumResolution, outSpectrum.GetData());
+}
+
+template<typename SampleType>
+void FSpectrumAnalyzer::CalculateFrequencySpectrum(const SampleType* samples, float sampleScale, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, float* outSpectrum)
+{
+	if (spectrumResolution <= 0) return;
+
+	if (samples == nullptr || numSamples <= 0 || sampleRate <= 0)
+	{
+		WriteSilence(spectrumResolution, outSpectrum);
+		return;
+	}
+
+	const int32 firstSample = (int32)PrepareFrame(numSamples, sampleRate, startTime, timeLength, inWindowType);
+
+	LoadFrame(samples, sampleScale, numSamples, firstSample);
+	fft.Forward();
+	fft.PowerSpectrum(power.GetData());
+	BucketPowerSpectrum(sampleRate, spectrumResolution, outSpectrum);
+}
+
+int32 FSpectrumAnalyzer::GetFFTSize(int32 sampleRate, float timeLength)
+{
+	// Same framing as the Blueprint node: round the slice up to a power of two
+	const int32 samplesToRead = FMath::Max(1, FMath::RoundToInt(timeLength * sampleRate));
+	return FMath::Max(MinimumFFTSize, (int32)FMath::RoundUpToPowerOfTwo(samplesToRead));
+}
+
+int64 FSpectrumAnalyzer::PrepareFrame(int64 numSamples, int32 sampleRate, float startTime, float timeLength, ESpectrumWindowType inWindowType)
+{
+	// Centred on the requested window
+	const int32 samplesToRead = FMath::Max(1, FMath::RoundToInt(timeLength * sampleRate));
+	Prepare(GetFFTSize(sampleRate, timeLength), inWindowType);
+
+	// 64 bit so hour long streamed tracks don't overflow the sample index
+	const int64 firstSample = (int64)((double)startTime * sampleRate + 0.5) - (fftSize - samplesToRead) / 2;
+	return FMath::Clamp<int64>(firstSample, 0, FMath::Max<int64>(0, numSamples - fftSize));
+}
+
+void FSpectrumAnalyzer::Prepare(int32 inFFTSize, ESpectrumWindowType inWindowType)
+{
+	if (inFFTSize == fftSize && inWindowType == windowType) return;
+
+	fftSize = inFFTSize;
+	windowType = inWindowType;
+	fft.Prepare(fftSize);
+
+	// Fold the coherent gain and int16 scale into the window so Hann/Blackman don't shift the dB range
+	window.SetNumUninitialized(fftSize);
+	SynthDSP::BuildWindow((SynthDSP::EWindowType)windowType, fftSize, PCMSampleScale, window.GetData());
+	power.SetNumUninitialized(fftSize / 2 + 1);
+}
+
+template<typename SampleType>
+void FSpectrumAnalyzer::LoadFrame(const SampleType* samples, float sampleScale, int32 numSamples, int32 firstSample)
+{
+	const int32 available = FMath::Clamp(numSamples - firstSample, 0, fftSize);
+	fft.LoadFrame(samples + firstSample, available, sampleScale, window.GetData());
+}
+
+void FSpectrumAnalyzer::WriteSilence(int32 spectrumResolution, float* outSpectrum)
+{
+	for (int i = 0; i < spectrumResolution; i++) outSpectrum[i] = DecibelScale * FMath::Loge(MinimumPower);
+}
+
+void FSpectrumAnalyzer::BucketPowerSpectrum(int32 sampleRate, int32 spectrumResolution, float* outSpectrum)
+{
+	// Normally built by PrepareFraming at arm time
+	if (!bandMatrix.IsBuilt(spectrumResolution, fftSize, sampleRate))
+	{
+		bandMatrix.Build(bandLayout, spectrumResolution, fftSize, sampleRate);
+	}
+
+	// Bands average in dB like the old node did, so convert every bin once and let the sparse matrix do the grouping
+	const float powerScale = 4.0f / ((float)fftSize * (float)fftSize);
+	SynthDSP::PowerToDecibels(power.GetData() + 1, fftSize / 2, powerScale, MinimumPower);
+
+	bandMatrix.Apply(power.GetData(), outSpectrum);
+}
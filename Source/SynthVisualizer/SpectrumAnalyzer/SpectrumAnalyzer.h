@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumBandLayout.h"
+#include "SynthDSP/RealFFT.h"
+#include "SpectrumAnalyzer.generated.h"
+
+struct FDecodedPCM;
+class FSynthPCMStream;
+
+UENUM(BlueprintType)
+enum class ESpectrumWindowType : uint8
+{
+	Rectangular,
+	Hann,
+	Hamming,
+	Blackman
+};
+
+/**
+ * Native replacement for the SoundVisualizations CalculateFrequencySpectrum node.
+ * Runs the SynthDSP real-input FFT over decoded mono PCM (see FSynthPCMCache) and groups the bins into bands
+ * (see FSpectrumBandLayout) on the same dB scale the Blueprint node produced, so existing spectrumClamp values still apply.
+ */
+class SYNTHVISUALIZER_API FSpectrumAnalyzer
+{
+public:
+	FSpectrumAnalyzer();
+
+	// Writes in place, outSpectrum has to hold spectrumResolution bands already
+	void CalculateFrequencySpectrum(const FDecodedPCM& pcm, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, TArrayView<float> outSpectrum);
+	// Streamed tracks, any part of the frame that isn't decoded yet reads as silence
+	void CalculateFrequencySpectrum(FSynthPCMStream& stream, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, TArrayView<float> outSpectrum);
+	void CalculateFrequencySpectrum(const float* samples, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, TArrayView<float> outSpectrum);
+	// Same as above, sizing outSpectrum first
+	void CalculateFrequencySpectrum(const FDecodedPCM& pcm, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, TArray<float>& outSpectrum);
+	void CalculateFrequencySpectrum(const float* samples, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, TArray<float>& outSpectrum);
+	// A different layout drops the band matrix, PrepareFraming (or the next frame) builds it again
+	void SetBandLayout(const FSpectrumBandLayout& inBandLayout);
+	// Builds the FFT tables, window and band matrix for a track's framing ahead of its first frame, so arming pays for them
+	// instead of the first update. Frames with any other framing still build what they need on the way through.
+	void PrepareFraming(int32 sampleRate, float timeLength, int32 spectrumResolution, ESpectrumWindowType inWindowType, bool isStreamed);
+
+private:
+	template<typename SampleType>
+	void CalculateFrequencySpectrum(const SampleType* samples, float sampleScale, int32 numSamples, int32 sampleRate, float startTime, float timeLength, int32 spectrumResolution, ESpectrumWindowType windowType, float* outSpectrum);
+	static int32 GetFFTSize(int32 sampleRate, float timeLength);
+	// Sizes the FFT for the slice and returns the first sample of the frame
+	int64 PrepareFrame(int64 numSamples, int32 sampleRate, float startTime, float timeLength, ESpectrumWindowType inWindowType);
+	void Prepare(int32 inFFTSize, ESpectrumWindowType inWindowType);
+	void WriteSilence(int32 spectrumResolution, float* outSpectrum);
+	template<typename SampleType>
+	void LoadFrame(const SampleType* samples, float sampleScale, int32 numSamples, int32 firstSample);
+	void BucketPowerSpectrum(int32 sampleRate, int32 spectrumResolution, float* outSpectrum);
+
+private:
+	int32 fftSize;
+	ESpectrumWindowType windowType;
+	FSpectrumBandLayout bandLayout;
+	FSpectrumBandMatrix bandMatrix;
+	SynthDSP::FRealFFT fft;
+
+	TArray<float> window;
+	TArray<float> power;
+	TArray<float> streamFrame;
+};
@@ -0,0 +1,57 @@
+#include "SpectrumArena.h"
+
+namespace
+{
+	constexpr uint32 ArenaAlignment = 64;
+	constexpr int32 FloatsPerLine = ArenaAlignment / sizeof(float);
+}
+
+FSpectrumArena::FSpectrumArena()
+{
+	data = nullptr;
+	numReserved = 0;
+	numAllocated = 0;
+}
+
+FSpectrumArena::~FSpectrumArena()
+{
+	Reset();
+}
+
+int32 FSpectrumArena::GetBlockStride(int32 count)
+{
+	return Align(FMath::Max(count, 0), FloatsPerLine);
+}
+
+int32 FSpectrumArena::Reserve(int32 count)
+{
+	check(data == nullptr);
+	const int32 offset = numReserved;
+	numReserved += GetBlockStride(count);
+	return offset;
+}
+
+void FSpectrumArena::Allocate()
+{
+	check(data == nullptr);
+	if (numReserved == 0) return;
+
+	// Zeroed so envelopes and peak holds start from silence
+	data = (float*)FMemory::Malloc((SIZE_T)numReserved * sizeof(float), ArenaAlignment);
+	FMemory::Memzero(data, (SIZE_T)numReserved * sizeof(float));
+	numAllocated = numReserved;
+}
+
+void FSpectrumArena::Reset()
+{
+	if (data != nullptr) FMemory::Free(data);
+	data = nullptr;
+	numReserved = 0;
+	numAllocated = 0;
+}
+
+TArrayView<float> FSpectrumArena::GetBlock(int32 offset, int32 count) const
+{
+	check(offset >= 0 && offset + count <= numAllocated);
+	return TArrayView<float>(data + offset, count);
+}
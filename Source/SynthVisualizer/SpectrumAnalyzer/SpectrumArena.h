@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One allocation holding the band buffers of every armed track. Blocks are reserved while the controller
+ * activates its tracks, Allocate then makes the single allocation and GetBlock hands out views into it.
+ * Every block starts on its own cache line so tracks updating in parallel never write to a shared line,
+ * and nothing is allocated again until the next activation.
+ */
+class SYNTHVISUALIZER_API FSpectrumArena
+{
+public:
+	FSpectrumArena();
+	~FSpectrumArena();
+	FSpectrumArena(const FSpectrumArena&) = delete;
+	FSpectrumArena& operator=(const FSpectrumArena&) = delete;
+
+	// Floats a block of count takes up, rounded to whole cache lines
+	static int32 GetBlockStride(int32 count);
+
+	// Returns the block's offset for GetBlock, blocks can only be reserved before Allocate
+	int32 Reserve(int32 count);
+	void Allocate();
+	void Reset();
+
+	TArrayView<float> GetBlock(int32 offset, int32 count) const;
+	SIZE_T GetAllocatedSize() const { return (SIZE_T)numAllocated * sizeof(float); }
+
+private:
+	float* data;
+	int32 numReserved;
+	int32 numAllocated;
+};
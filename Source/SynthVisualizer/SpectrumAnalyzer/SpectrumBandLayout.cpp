@@ -0,0 +1,158 @@
+#include "SpectrumBandLayout.h"
+
+namespace
+{
+	float ToBandScale(ESpectrumBandScale scale, float frequency)
+	{
+		switch (scale)
+		{
+		case ESpectrumBandScale::Mel:
+			return 2595.0f * FMath::LogX(10.0f, 1.0f + frequency / 700.0f);
+		case ESpectrumBandScale::Linear:
+			return frequency;
+		default:
+			return FMath::Loge(frequency);
+		}
+	}
+
+	float FromBandScale(ESpectrumBandScale scale, float value)
+	{
+		switch (scale)
+		{
+		case ESpectrumBandScale::Mel:
+			return 700.0f * (FMath::Pow(10.0f, value / 2595.0f) - 1.0f);
+		case ESpectrumBandScale::Linear:
+			return value;
+		default:
+			return FMath::Exp(value);
+		}
+	}
+
+	bool AreEdgesAscending(const TArray<float>& edges)
+	{
+		for (int i = 1; i < edges.Num(); i++)
+		{
+			if (edges[i] <= edges[i - 1]) return false;
+		}
+		return edges.Num() > 1 && edges[0] > 0.0f;
+	}
+}
+
+FSpectrumBandLayout::FSpectrumBandLayout()
+{
+	scale = ESpectrumBandScale::Linear;
+	minFrequencyHz = 20.0f;
+	maxFrequencyHz = 20000.0f;
+	customBandEdges = TArray<float>();
+	interpolateBands = false;
+}
+
+bool FSpectrumBandLayout::operator==(const FSpectrumBandLayout& other) const
+{
+	return scale == other.scale
+		&& minFrequencyHz == other.minFrequencyHz
+		&& maxFrequencyHz == other.maxFrequencyHz
+		&& customBandEdges == other.customBandEdges
+		&& interpolateBands == other.interpolateBands;
+}
+
+FString FSpectrumBandLayout::ToKeyString() const
+{
+	FString keyString = FString::Printf(TEXT("%d_%.2f_%.2f_%d"), (int32)scale, minFrequencyHz, maxFrequencyHz, interpolateBands ? 1 : 0);
+	if (scale == ESpectrumBandScale::Custom)
+	{
+		for (float edge : customBandEdges) keyString += FString::Printf(TEXT("_%.2f"), edge);
+	}
+	return keyString;
+}
+
+FSpectrumBandMatrix::FSpectrumBandMatrix()
+{
+	numBands = 0;
+	builtFFTSize = 0;
+	builtSampleRate = 0;
+}
+
+void FSpectrumBandMatrix::Reset()
+{
+	numBands = 0;
+	builtFFTSize = 0;
+	builtSampleRate = 0;
+	matrix.Reset();
+}
+
+void FSpectrumBandMatrix::Build(const FSpectrumBandLayout& layout, int32 inNumBands, int32 fftSize, int32 sampleRate)
+{
+	numBands = inNumBands;
+	builtFFTSize = fftSize;
+	builtSampleRate = sampleRate;
+	matrix.Reset();
+
+	const int32 halfSize = fftSize / 2;
+	if (numBands <= 0 || halfSize <= 0 || sampleRate <= 0) return;
+
+	ESpectrumBandScale bandScale = layout.scale;
+	if (bandScale == ESpectrumBandScale::Custom && (layout.customBandEdges.Num() != numBands + 1 || !AreEdgesAscending(layout.customBandEdges)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Spectrum Band Matrix: Custom band edges need %d ascending frequencies, using logarithmic bands instead."), numBands + 1);
+		bandScale = ESpectrumBandScale::Logarithmic;
+	}
+
+	// Linear hard edged bands are the original DC skipping buckets, kept bit for bit so existing tuning still applies
+	if (bandScale == ESpectrumBandScale::Linear && !layout.interpolateBands)
+	{
+		matrix.BuildLinearBuckets(numBands, halfSize);
+		return;
+	}
+
+	// Band edges in fractional bin units, bin k sits at k * sampleRate / fftSize Hz
+	const float binFrequency = (float)sampleRate / fftSize;
+	const float nyquist = halfSize * binFrequency;
+	TArray<float> edgeBins;
+	edgeBins.SetNumUninitialized(numBands + 1);
+	if (bandScale == ESpectrumBandScale::Custom)
+	{
+		for (int i = 0; i <= numBands; i++) edgeBins[i] = FMath::Min(layout.customBandEdges[i], nyquist) / binFrequency;
+	}
+	else if (bandScale == ESpectrumBandScale::Linear)
+	{
+		for (int i = 0; i <= numBands; i++) edgeBins[i] = 1.0f + (float)i * halfSize / numBands;
+	}
+	else
+	{
+		float lowFrequency = FMath::Clamp(layout.minFrequencyHz, 1.0f, nyquist);
+		float highFrequency = FMath::Clamp(layout.maxFrequencyHz, 1.0f, nyquist);
+		if (highFrequency <= lowFrequency)
+		{
+			lowFrequency = FMath::Min(binFrequency, nyquist * 0.5f);
+			highFrequency = nyquist;
+		}
+
+		const float lowScaled = ToBandScale(bandScale, lowFrequency);
+		const float highScaled = ToBandScale(bandScale, highFrequency);
+		for (int i = 0; i <= numBands; i++)
+		{
+			edgeBins[i] = FromBandScale(bandScale, FMath::Lerp(lowScaled, highScaled, (float)i / numBands)) / binFrequency;
+		}
+	}
+
+	if (!layout.interpolateBands)
+	{
+		matrix.BuildHardEdged(edgeBins.GetData(), numBands, halfSize);
+		return;
+	}
+
+	// Triangle centres sit halfway between the edges on the layout's own scale, which is defined in Hz not bins.
+	// Every edge is above 0 Hz here, custom edges are validated and the others start at or above the first bin.
+	const ESpectrumBandScale centreScale = bandScale == ESpectrumBandScale::Custom ? ESpectrumBandScale::Logarithmic : bandScale;
+	TArray<float> centreBins;
+	centreBins.SetNumUninitialized(numBands);
+	for (int32 band = 0; band < numBands; band++)
+	{
+		const float lowScaled = ToBandScale(centreScale, edgeBins[band] * binFrequency);
+		const float highScaled = ToBandScale(centreScale, edgeBins[band + 1] * binFrequency);
+		centreBins[band] = FromBandScale(centreScale, 0.5f * (lowScaled + highScaled)) / binFrequency;
+	}
+
+	matrix.BuildTriangular(edgeBins.GetData(), centreBins.GetData(), numBands, halfSize);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SynthDSP/BandMatrix.h"
+#include "SpectrumBandLayout.generated.h"
+
+UENUM(BlueprintType)
+enum class ESpectrumBandScale : uint8
+{
+	Linear,
+	Logarithmic,
+	Mel,
+	Custom
+};
+
+/**
+ * How a track's FFT bins are grouped into its spectrumResolution bands.
+ * Linear reproduces the original evenly spaced buckets, the other scales spend more bands on the low end.
+ */
+USTRUCT(BlueprintType)
+struct SYNTHVISUALIZER_API FSpectrumBandLayout
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bands")
+	ESpectrumBandScale scale;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bands", meta = (EditCondition = "scale != ESpectrumBandScale::Linear", ClampMin = "1"))
+	float minFrequencyHz;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bands", meta = (EditCondition = "scale != ESpectrumBandScale::Linear", ClampMin = "1"))
+	float maxFrequencyHz;
+	// Ascending band edges in Hz, needs spectrumResolution + 1 entries
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bands", meta = (EditCondition = "scale == ESpectrumBandScale::Custom"))
+	TArray<float> customBandEdges;
+	// Overlapping triangular bands instead of hard edges, bands narrower than a bin blend their two nearest bins
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spectrum Bands")
+	bool interpolateBands;
+
+	FSpectrumBandLayout();
+
+	bool operator==(const FSpectrumBandLayout& other) const;
+	bool operator!=(const FSpectrumBandLayout& other) const { return !(*this == other); }
+	FString ToKeyString() const;
+};
+
+/**
+ * Sparse bin -> band weights (see SynthDSP::FBandMatrix) built once for a given FFT framing.
+ * Turns a layout into band edges in bin units, the DSP core owns the weights and the apply kernel.
+ */
+struct SYNTHVISUALIZER_API FSpectrumBandMatrix
+{
+public:
+	FSpectrumBandMatrix();
+
+	void Build(const FSpectrumBandLayout& layout, int32 inNumBands, int32 fftSize, int32 sampleRate);
+	void Reset();
+	// Framing only, the owner resets the matrix when its layout changes so the per frame check stays a few compares
+	FORCEINLINE bool IsBuilt(int32 inNumBands, int32 fftSize, int32 sampleRate) const { return numBands == inNumBands && builtFFTSize == fftSize && builtSampleRate == sampleRate; }
+	FORCEINLINE void Apply(const float* binValues, float* outBands) const { matrix.Apply(binValues, outBands); }
+	FORCEINLINE int32 GetNumBands() const { return numBands; }
+
+private:
+	int32 numBands;
+	int32 builtFFTSize;
+	int32 builtSampleRate;
+	SynthDSP::FBandMatrix matrix;
+};
@@ -8,11 +8,17 @@ public class SynthVisualizer : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "SoundVisualizations", "UMG" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "SoundVisualizations", "UMG", "SynthDSP" });
 
 
         PrivateDependencyModuleNames.AddRange(new string[] { "SoundVisualizations" });
 
+		if (Target.bBuildEditor)
+		{
+			// Spectrogram assets are generated through the DDC at cook time
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
+
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
 		
@@ -4,3 +4,23 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SynthVisualizer, "SynthVisualizer" );
+
+DEFINE_STAT(STAT_SynthUpdateFrequencySpectrums);
+DEFINE_STAT(STAT_SynthSpectrumAnalysis);
+DEFINE_STAT(STAT_SynthNormalizeSpectrum);
+DEFINE_STAT(STAT_SynthSpectrumEnvelopes);
+DEFINE_STAT(STAT_SynthWorkerAnalysis);
+DEFINE_STAT(STAT_SynthSpectrogramBake);
+DEFINE_STAT(STAT_SynthMusicEvents);
+DEFINE_STAT(STAT_SynthEvaluateSpectrum);
+DEFINE_STAT(STAT_SynthUpdateResponders);
+DEFINE_STAT(STAT_SynthMaterialParameters);
+DEFINE_STAT(STAT_SynthBarInstances);
+DEFINE_STAT(STAT_SynthDebugDraw);
+DEFINE_STAT(STAT_SynthArmedTracks);
+DEFINE_STAT(STAT_SynthSpectrumBins);
+DEFINE_STAT(STAT_SynthSpectrumQueries);
+DEFINE_STAT(STAT_SynthRespondersUpdated);
+DEFINE_STAT(STAT_SynthSpectrumMemory);
+
+CSV_DEFINE_CATEGORY_MODULE(SYNTHVISUALIZER_API, SynthVisualizer, true);
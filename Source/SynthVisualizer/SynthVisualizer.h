@@ -3,4 +3,42 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+// stat SynthVisualizer
+DECLARE_STATS_GROUP(TEXT("SynthVisualizer"), STATGROUP_SynthVisualizer, STATCAT_Advanced);
+
+// Analysis
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Frequency Spectrums"), STAT_SynthUpdateFrequencySpectrums, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Track Spectrum Analysis"), STAT_SynthSpectrumAnalysis, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Normalize Spectrum"), STAT_SynthNormalizeSpectrum, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spectrum Envelopes"), STAT_SynthSpectrumEnvelopes, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Worker Spectrum Analysis"), STAT_SynthWorkerAnalysis, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spectrogram Bake"), STAT_SynthSpectrogramBake, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Music Events"), STAT_SynthMusicEvents, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+
+// Queries and responders
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate Normalized Spectrum"), STAT_SynthEvaluateSpectrum, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Responders"), STAT_SynthUpdateResponders, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Material Parameter Writes"), STAT_SynthMaterialParameters, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bar Instance Update"), STAT_SynthBarInstances, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Debug Draw"), STAT_SynthDebugDraw, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+
+// Per frame counters
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Armed Tracks"), STAT_SynthArmedTracks, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Spectrum Bins"), STAT_SynthSpectrumBins, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Spectrum Queries"), STAT_SynthSpectrumQueries, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Responders Updated"), STAT_SynthRespondersUpdated, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+
+// Memory
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Spectrum Memory"), STAT_SynthSpectrumMemory, STATGROUP_SynthVisualizer, SYNTHVISUALIZER_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SYNTHVISUALIZER_API, SynthVisualizer);
+
+// Cycle stat, CSV timer and Insights event over the same region, Name is the STAT_Synth<Name> suffix
+#define SYNTH_VISUALIZER_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Synth##Name); \
+	CSV_SCOPED_TIMING_STAT(SynthVisualizer, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Synth##Name)
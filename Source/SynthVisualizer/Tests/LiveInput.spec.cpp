@@ -0,0 +1,85 @@
+#include "Misc/AutomationTest.h"
+#include "SynthVisualizer/LiveInput/SynthLiveInput.h"
+#include "SynthVisualizer/LiveInput/SynthFileAudioSource.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "SynthVisualizer/Tests/SynthAnalysisTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SynthAnalysisTest;
+
+namespace
+{
+	constexpr int32 SineBin = 64;
+	constexpr float SineAmplitude = 0.5f;
+}
+
+BEGIN_DEFINE_SPEC(FSynthLiveInputSpec, "SynthVisualizer.LiveInput", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	FDecodedPCMPtr pcm;
+	TUniquePtr<FSynthLiveInput> input;
+	TUniquePtr<FSynthFileAudioSource> source;
+END_DEFINE_SPEC(FSynthLiveInputSpec)
+
+void FSynthLiveInputSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		pcm = MakeSinePCM(0.5f, BinFrequency(SineBin), SineAmplitude);
+		input = MakeUnique<FSynthLiveInput>(SampleRate, 2.0f * TimeSlice);
+		source = MakeUnique<FSynthFileAudioSource>(pcm);
+	});
+
+	AfterEach([this]()
+	{
+		source.Reset();
+		input.Reset();
+		pcm.Reset();
+	});
+
+	It("reads the newest frame like an authored one", [this]()
+	{
+		// Odd block sizes so the ring and history wrap at every offset
+		for (int32 block = 0; block < 64; block++)
+		{
+			source->PumpFrames(*input, 97 + block * 31);
+			input->Update();
+		}
+
+		int32 numHistory = 0;
+		const float* history = input->GetHistory(numHistory);
+		const int32 numBands = FFTSize / 2;
+		FSpectrumAnalyzer analyzer;
+		TArray<float> spectrum;
+		analyzer.CalculateFrequencySpectrum(history, numHistory, input->GetSampleRate(), (float)numHistory / input->GetSampleRate(), TimeSlice, numBands, ESpectrumWindowType::Hann, spectrum);
+
+		const int32 peakBand = FindPeakBand(spectrum);
+		TestEqual(TEXT("Peak band"), peakBand, ExpectedLinearBand(BinFrequency(SineBin), numBands));
+		TestEqual(TEXT("Peak level"), spectrum[peakBand], SineDecibels(SineAmplitude), DecibelTolerance);
+	});
+
+	It("mixes identical stereo channels down to the same signal", [this]()
+	{
+		TArray<float> stereo;
+		stereo.SetNumUninitialized(FFTSize * 2);
+		const float* expected = pcm->GetFloatData();
+		for (int32 i = 0; i < FFTSize; i++) stereo[2 * i] = stereo[2 * i + 1] = expected[i];
+		input->PushSamples(stereo.GetData(), FFTSize, 2);
+		input->Update();
+
+		int32 numHistory = 0;
+		const float* history = input->GetHistory(numHistory);
+		for (int32 i = 0; i < FFTSize; i++)
+		{
+			if (!TestEqual(FString::Printf(TEXT("Sample %d"), i), history[numHistory - FFTSize + i], expected[i], NormalizeTolerance)) break;
+		}
+	});
+
+	It("drops new audio at the producer when the consumer never drains", [this]()
+	{
+		const uint32 droppedBefore = input->GetDroppedSamples();
+		source->PumpFrames(*input, SampleRate * 2);
+		TestTrue(TEXT("A full ring counted dropped samples"), input->GetDroppedSamples() > droppedBefore);
+	});
+}
+
+#endif
@@ -0,0 +1,78 @@
+#include "Misc/AutomationTest.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+#include "SynthVisualizer/Tests/SynthAnalysisTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SynthAnalysisTest;
+
+namespace
+{
+	// Half keeps 11 significant bits, rounding error stays under 0.032 dB for any level below 128 dB
+	constexpr float HalfTolerance = 0.05f;
+}
+
+BEGIN_DEFINE_SPEC(FSynthSpectrogramSpec, "SynthVisualizer.Spectrogram", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	FSpectrogram reference;
+	TArray<float> expectedFrame;
+	TArray<float> compactFrame;
+END_DEFINE_SPEC(FSynthSpectrogramSpec)
+
+void FSynthSpectrogramSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		FDecodedPCMPtr pcm = MakeNoisePCM(1.0f, 4321);
+		reference.Reset();
+		FSpectrogram::Bake(*pcm, TimeSlice, 64, ESpectrumWindowType::Hann, FSpectrumBandLayout(), FrameRate, reference);
+		expectedFrame.SetNumUninitialized(reference.numBins);
+		compactFrame.SetNumUninitialized(reference.numBins);
+	});
+
+	It("reads Half frames back within half precision", [this]()
+	{
+		FSpectrogram compact = reference;
+		compact.Compact(ESynthSpectrogramFormat::Half);
+		TestTrue(TEXT("Half frames are smaller"), compact.frames.Num() < reference.frames.Num());
+
+		for (int32 frame = 0; frame < reference.numFrames; frame++)
+		{
+			reference.ReadFrame(frame, expectedFrame.GetData());
+			compact.ReadFrame(frame, compactFrame.GetData());
+			for (int32 bin = 0; bin < reference.numBins; bin++)
+			{
+				if (!TestEqual(FString::Printf(TEXT("Frame %d bin %d"), frame, bin), compactFrame[bin], expectedFrame[bin], HalfTolerance)) return;
+			}
+		}
+	});
+
+	It("reads UInt8 frames back within half a step of each frame's range", [this]()
+	{
+		FSpectrogram compact = reference;
+		compact.Compact(ESynthSpectrogramFormat::UInt8);
+		TestTrue(TEXT("UInt8 frames are smaller"), compact.frames.Num() < reference.frames.Num());
+
+		for (int32 frame = 0; frame < reference.numFrames; frame++)
+		{
+			reference.ReadFrame(frame, expectedFrame.GetData());
+			compact.ReadFrame(frame, compactFrame.GetData());
+
+			// Codes span each frame's own range
+			float minimum = expectedFrame[0];
+			float maximum = expectedFrame[0];
+			for (float value : expectedFrame)
+			{
+				minimum = FMath::Min(minimum, value);
+				maximum = FMath::Max(maximum, value);
+			}
+			const float tolerance = 0.5f * (maximum - minimum) / 255.0f + KINDA_SMALL_NUMBER;
+
+			for (int32 bin = 0; bin < reference.numBins; bin++)
+			{
+				if (!TestEqual(FString::Printf(TEXT("Frame %d bin %d"), frame, bin), compactFrame[bin], expectedFrame[bin], tolerance)) return;
+			}
+		}
+	});
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "Misc/AutomationTest.h"
+#include "SynthVisualizer/SpectrumAnalyzer/SpectrumAnalyzer.h"
+#include "SynthVisualizer/Tests/SynthAnalysisTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SynthAnalysisTest;
+
+namespace
+{
+	// Low and high quarter of the bands may differ by this much for white noise
+	constexpr float FlatnessTolerance = 1.0f;
+}
+
+BEGIN_DEFINE_SPEC(FSynthSpectrumAnalyzerSpec, "SynthVisualizer.SpectrumAnalyzer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	FSpectrumAnalyzer analyzer;
+	TArray<float> spectrum;
+END_DEFINE_SPEC(FSynthSpectrumAnalyzerSpec)
+
+void FSynthSpectrumAnalyzerSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		analyzer.SetBandLayout(FSpectrumBandLayout());
+		spectrum.Reset();
+	});
+
+	Describe("A bin centred sine", [this]()
+	{
+		const int32 sineBins[] = { 8, 64, 200, 500 };
+		const float amplitudes[] = { 1.0f, 0.25f };
+		for (float amplitude : amplitudes)
+		{
+			for (int32 bin : sineBins)
+			{
+				It(FString::Printf(TEXT("at %.0f Hz and %.2f lands in one band at full level"), BinFrequency(bin), amplitude), [this, bin, amplitude]()
+				{
+					const int32 numBands = FFTSize / 2;
+					const float frequency = BinFrequency(bin);
+					FDecodedPCMPtr pcm = MakeSinePCM(0.1f, frequency, amplitude);
+					analyzer.CalculateFrequencySpectrum(*pcm, 0.02f, TimeSlice, numBands, ESpectrumWindowType::Hann, spectrum);
+
+					const int32 peakBand = FindPeakBand(spectrum);
+					TestEqual(TEXT("Peak band"), peakBand, ExpectedLinearBand(frequency, numBands));
+					TestEqual(TEXT("Peak level"), spectrum[peakBand], SineDecibels(amplitude), DecibelTolerance);
+				});
+			}
+		}
+
+		It("peaks in the right logarithmic band", [this]()
+		{
+			// Off bin, so only the band placement is exact enough to check
+			FSpectrumBandLayout logLayout;
+			logLayout.scale = ESpectrumBandScale::Logarithmic;
+			analyzer.SetBandLayout(logLayout);
+
+			const int32 numBands = 32;
+			const float frequency = 1000.0f;
+			FDecodedPCMPtr pcm = MakeSinePCM(0.1f, frequency, 0.5f);
+			analyzer.CalculateFrequencySpectrum(*pcm, 0.02f, TimeSlice, numBands, ESpectrumWindowType::Hann, spectrum);
+
+			const float bandPosition = FMath::Loge(frequency / logLayout.minFrequencyHz) / FMath::Loge(logLayout.maxFrequencyHz / logLayout.minFrequencyHz);
+			const int32 expectedBand = FMath::FloorToInt(bandPosition * numBands);
+			TestTrue(FString::Printf(TEXT("Peak band %d within one of %d"), FindPeakBand(spectrum), expectedBand), FMath::Abs(FindPeakBand(spectrum) - expectedBand) <= 1);
+		});
+	});
+
+	It("reads a unit impulse as a flat spectrum", [this]()
+	{
+		// Rectangular window so the impulse's position in the frame doesn't matter
+		const int32 numBands = FFTSize / 2;
+		const int32 impulseSample = 1000;
+		const float amplitude = 0.5f;
+		FDecodedPCMPtr pcm = MakeSyntheticPCM(0.1f, [impulseSample, amplitude](int32 sample) { return sample == impulseSample ? amplitude : 0.0f; });
+		analyzer.CalculateFrequencySpectrum(*pcm, (float)(impulseSample - FFTSize / 2) / SampleRate, TimeSlice, numBands, ESpectrumWindowType::Rectangular, spectrum);
+
+		const float expectedLevel = SineDecibels(amplitude * 2.0f / FFTSize);
+		for (int32 band = 0; band < numBands; band++)
+		{
+			if (!TestEqual(FString::Printf(TEXT("Band %d"), band), spectrum[band], expectedLevel, DecibelTolerance)) break;
+		}
+	});
+
+	It("reads white noise at the same level across the bands", [this]()
+	{
+		// Averaged over enough frames the bottom and top quarter of the bands should match
+		const int32 numBands = 64;
+		const int32 numFrames = 32;
+		FDecodedPCMPtr pcm = MakeNoisePCM(2.0f, 1234);
+
+		double lowSum = 0.0;
+		double highSum = 0.0;
+		const int32 quarter = numBands / 4;
+		for (int32 frame = 0; frame < numFrames; frame++)
+		{
+			analyzer.CalculateFrequencySpectrum(*pcm, frame * 0.05f, TimeSlice, numBands, ESpectrumWindowType::Hann, spectrum);
+			for (int32 band = 0; band < quarter; band++)
+			{
+				lowSum += spectrum[band];
+				highSum += spectrum[numBands - 1 - band];
+			}
+		}
+
+		TestEqual(TEXT("High bands against low bands"), (float)(highSum / (quarter * numFrames)), (float)(lowSum / (quarter * numFrames)), FlatnessTolerance);
+	});
+
+	It("follows a sweep", [this]()
+	{
+		// Linear chirp, the peak should follow the instantaneous frequency at the centre of each frame
+		const int32 numBands = 64;
+		const float duration = 2.0f;
+		const float startFrequency = 200.0f;
+		const float endFrequency = 20000.0f;
+		const float sweepRate = (endFrequency - startFrequency) / duration;
+		FDecodedPCMPtr pcm = MakeSyntheticPCM(duration, [startFrequency, sweepRate](int32 sample)
+		{
+			const float time = (float)sample / SampleRate;
+			return 0.5f * FMath::Sin(2.0f * PI * (startFrequency * time + 0.5f * sweepRate * time * time));
+		});
+
+		for (float time = 0.1f; time < duration - 0.1f; time += 0.1f)
+		{
+			analyzer.CalculateFrequencySpectrum(*pcm, time, TimeSlice, numBands, ESpectrumWindowType::Hann, spectrum);
+
+			const int32 expectedBand = ExpectedLinearBand(startFrequency + sweepRate * (time + 0.5f * TimeSlice), numBands);
+			const int32 peakBand = FindPeakBand(spectrum);
+			if (!TestTrue(FString::Printf(TEXT("Peak band %d at %.2f s within one of %d"), peakBand, time, expectedBand), FMath::Abs(peakBand - expectedBand) <= 1)) break;
+		}
+	});
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "SynthVisualizer/PCMCache/SynthPCMCache.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Synthetic signals shared by the analysis automation tests.
+ * A 1024 point FFT at 48 kHz, so a 512 band linear layout is exactly one bin per band.
+ */
+namespace SynthAnalysisTest
+{
+	constexpr int32 SampleRate = 48000;
+	constexpr int32 FFTSize = 1024;
+	constexpr float TimeSlice = (float)FFTSize / SampleRate;
+	constexpr float DecibelTolerance = 0.5f;
+	constexpr float NormalizeTolerance = 1.0e-5f;
+	constexpr float FrameRate = 60.0f;
+
+	// dB level of a bin centred sine of the given amplitude, on the int16 scale the analyzer reports
+	inline float SineDecibels(float amplitude)
+	{
+		return 20.0f * FMath::LogX(10.0f, amplitude * 32768.0f);
+	}
+
+	inline FDecodedPCMPtr MakeSyntheticPCM(float duration, TFunctionRef<float(int32 sample)> generator)
+	{
+		const int32 numSamples = FMath::RoundToInt(duration * SampleRate);
+		TSharedPtr<FDecodedPCM, ESPMode::ThreadSafe> pcm = MakeShared<FDecodedPCM, ESPMode::ThreadSafe>(ESynthPCMFormat::Float, numSamples, SampleRate);
+		float* samples = (float*)pcm->GetMutableData();
+		for (int32 i = 0; i < numSamples; i++) samples[i] = generator(i);
+		return pcm;
+	}
+
+	inline FDecodedPCMPtr MakeSinePCM(float duration, float frequency, float amplitude)
+	{
+		return MakeSyntheticPCM(duration, [frequency, amplitude](int32 sample) { return amplitude * FMath::Sin(2.0f * PI * frequency * sample / SampleRate); });
+	}
+
+	inline FDecodedPCMPtr MakeNoisePCM(float duration, int32 seed)
+	{
+		FRandomStream random(seed);
+		return MakeSyntheticPCM(duration, [&random](int32 sample) { return random.FRandRange(-0.5f, 0.5f); });
+	}
+
+	// Frequency at the centre of an FFT bin
+	inline float BinFrequency(int32 bin)
+	{
+		return (float)bin * SampleRate / FFTSize;
+	}
+
+	// Band a frequency lands in for the default DC skipping linear layout
+	inline int32 ExpectedLinearBand(float frequency, int32 numBands)
+	{
+		const int32 bin = FMath::RoundToInt(frequency * FFTSize / SampleRate);
+		return FMath::Clamp((bin - 1) * numBands / (FFTSize / 2), 0, numBands - 1);
+	}
+
+	inline int32 FindPeakBand(const TArray<float>& spectrum)
+	{
+		int32 peakBand = 0;
+		for (int32 band = 1; band < spectrum.Num(); band++)
+		{
+			if (spectrum[band] > spectrum[peakBand]) peakBand = band;
+		}
+		return peakBand;
+	}
+}
+
+#endif
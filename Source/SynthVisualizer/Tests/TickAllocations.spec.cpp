@@ -0,0 +1,81 @@
+#include "Misc/AutomationTest.h"
+#include "SynthVisualizer/Benchmark/SynthCountingMalloc.h"
+#include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/MusicResponder/MusicResponder.h"
+#include "SynthVisualizer/Spectrogram/Spectrogram.h"
+#include "SynthVisualizer/Tests/SynthAnalysisTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SynthAnalysisTest;
+
+namespace
+{
+	constexpr int32 TickFrames = 2000;
+	constexpr int32 TickBarCount = 64;
+}
+
+/**
+ * The controller's tick over a game thread analyzed track and a compact baked one must not allocate.
+ * Worker and parallel updates are off so every tick runs on this thread, and only this thread's calls are counted,
+ * which lets the check demand exactly zero instead of leaving slack for whatever else the engine is doing.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSynthTickAllocationTest, "SynthVisualizer.MusicController.TickAllocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSynthTickAllocationTest::RunTest(const FString& Parameters)
+{
+	FDecodedPCMPtr pcm = MakeNoisePCM(2.0f, 8765);
+
+	// Armed the way ActivateArmedTracks expects
+	AMusicController* controller = NewObject<AMusicController>();
+	controller->AnalyzeOnWorkerThread = false;
+	controller->ParallelTrackUpdates = false;
+	controller->MasterTrack.trackID = FName("Analyzed");
+	controller->MasterTrack.pcm = pcm;
+	controller->MasterTrack.isArmed = true;
+
+	FTrackData& bakedTrack = controller->detailTracks.AddDefaulted_GetRef();
+	bakedTrack.trackID = FName("Baked");
+	FSpectrogram::Bake(*pcm, bakedTrack.spectrumTimeSlice, bakedTrack.spectrumResolution, bakedTrack.spectrumWindow, bakedTrack.bandLayout, FrameRate, bakedTrack.spectrogram);
+	bakedTrack.spectrogram.Compact(ESynthSpectrogramFormat::UInt8);
+	bakedTrack.isArmed = true;
+	controller->ActivateArmedTracks();
+
+	FTrackResponse response;
+	response.trackName = FName("Baked");
+	response.frequencyTune = 0.25f;
+	response.signal = ESynthResponseSignal::Envelope;
+	TArray<float> barValues;
+	barValues.SetNumUninitialized(TickBarCount);
+
+	const float deltaTime = 1.0f / FrameRate;
+	auto tick = [&](int32 frame)
+	{
+		controller->songTime = FMath::Fmod(frame * deltaTime, pcm->GetDuration());
+		controller->UpdateFrequencySpectrums();
+		controller->UpdateSpectrumEnvelopes(deltaTime);
+		controller->EvaluateTrackResponse(response);
+		controller->MasterTrack.EvaluateNormalizedBars(TickBarCount, barValues.GetData());
+	};
+
+	// Activation already built the FFT tables and band matrix, so the very first tick is counted too
+	const float* spectrumData = controller->MasterTrack.spectrum.GetData();
+	const SIZE_T arenaSize = controller->spectrumArena.GetAllocatedSize();
+
+	FSynthCountingMalloc* countingMalloc = FSynthCountingMalloc::Install();
+	const FSynthCountingMalloc::FCounts countsBefore = countingMalloc->GetThreadCounts();
+	for (int32 frame = 0; frame < TickFrames; frame++) tick(frame);
+	const FSynthCountingMalloc::FCounts countsAfter = countingMalloc->GetThreadCounts();
+	countingMalloc->Uninstall();
+
+	TestEqual(FString::Printf(TEXT("Allocations over %d ticks"), TickFrames), (int32)(countsAfter.allocations - countsBefore.allocations), 0);
+	TestEqual(TEXT("Frees over the ticks"), (int32)(countsAfter.frees - countsBefore.frees), 0);
+	// The arena is only reallocated when tracks are activated, the bound views must not have moved
+	TestTrue(TEXT("Spectrum still reads from the arena block"), controller->MasterTrack.spectrum.GetData() == spectrumData);
+	TestEqual(TEXT("Arena size"), (int64)controller->spectrumArena.GetAllocatedSize(), (int64)arenaSize);
+
+	controller->DisarmTrack();
+	return true;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "Misc/AutomationTest.h"
+#include "SynthVisualizer/MusicController/MusicController.h"
+#include "SynthVisualizer/Tests/SynthAnalysisTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SynthAnalysisTest;
+
+namespace
+{
+	// FastLog2/FastExp2 error for non integer power factors
+	constexpr float FastPowerTolerance = 5.0e-3f;
+	// Seven bands covers both the vector and the scalar tail of BuildNormalizedSpectrum
+	const float BandLevels[] = { -100.0f, -60.0f, -30.0f, 0.0f, 30.0f, 60.0f, 100.0f };
+}
+
+BEGIN_DEFINE_SPEC(FSynthTrackNormalizationSpec, "SynthVisualizer.MusicController.Normalization", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	TUniquePtr<FTrackData> track;
+	TUniquePtr<FSpectrumArena> arena;
+END_DEFINE_SPEC(FSynthTrackNormalizationSpec)
+
+void FSynthTrackNormalizationSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		// Bound the way the controller's activation binds its armed tracks
+		track = MakeUnique<FTrackData>();
+		arena = MakeUnique<FSpectrumArena>();
+		track->spectrumClamp = 60.0f;
+		track->spectrumResolution = UE_ARRAY_COUNT(BandLevels);
+		track->isArmed = true;
+		track->ReserveSpectrumBuffers(*arena);
+		arena->Allocate();
+		track->BindSpectrumBuffers(*arena);
+		FMemory::Memcpy(track->spectrum.GetData(), BandLevels, sizeof(BandLevels));
+	});
+
+	AfterEach([this]()
+	{
+		track.Reset();
+		arena.Reset();
+	});
+
+	const float powerFactors[] = { 1.0f, 2.0f, 1.5f };
+	for (float powerFactor : powerFactors)
+	{
+		It(FString::Printf(TEXT("clamps, normalizes and applies a power of %.1f"), powerFactor), [this, powerFactor]()
+		{
+			track->spectrumPowerFactor = powerFactor;
+			track->BuildNormalizedSpectrum();
+
+			const float clamp = track->spectrumClamp;
+			const float tolerance = FMath::IsNearlyEqual(powerFactor, FMath::RoundToFloat(powerFactor)) ? NormalizeTolerance : FastPowerTolerance;
+			for (int32 band = 0; band < track->spectrum.Num(); band++)
+			{
+				const float expected = FMath::Pow((FMath::Clamp(track->spectrum[band], -clamp, clamp) + clamp) / (2.0f * clamp), powerFactor);
+				const float actual = track->EvaluateNormalizedFrequency((float)band / (track->spectrum.Num() - 1));
+				if (!TestEqual(FString::Printf(TEXT("Band %d (%.1f dB)"), band, track->spectrum[band]), actual, expected, tolerance)) break;
+			}
+		});
+	}
+
+	It("blends the two nearest bands when the layout interpolates", [this]()
+	{
+		track->spectrumPowerFactor = 1.0f;
+		track->bandLayout.interpolateBands = true;
+		track->BuildNormalizedSpectrum();
+
+		const float midpoint = track->EvaluateNormalizedFrequency(2.5f / (track->spectrum.Num() - 1));
+		TestEqual(TEXT("Midpoint"), midpoint, 0.5f * (track->normalizedSpectrum[2] + track->normalizedSpectrum[3]), NormalizeTolerance);
+	});
+
+	It("reads a disarmed track as silence", [this]()
+	{
+		track->BuildNormalizedSpectrum();
+		track->isArmed = false;
+		TestEqual(TEXT("Disarmed value"), track->EvaluateNormalizedFrequency(0.5f), 0.0f);
+	});
+}
+
+#endif
@@ -9,6 +9,6 @@ public class SynthVisualizerEditorTarget : TargetRules
 	{
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
-		ExtraModuleNames.AddRange( new string[] { "SynthVisualizer" } );
+		ExtraModuleNames.AddRange( new string[] { "SynthVisualizer", "SynthDSP" } );
 	}
 }
@@ -0,0 +1,111 @@
+#include "SynthDSPTest.h"
+#include "SynthDSP/BandMatrix.h"
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+	// Bin k holds k, so a band's output is the weighted mean bin it reads
+	std::vector<float> MakeBinIndexRamp(int32_t halfSize)
+	{
+		std::vector<float> bins(halfSize + 1);
+		std::iota(bins.begin(), bins.end(), 0.0f);
+		return bins;
+	}
+
+	void TestLinearBuckets()
+	{
+		// The original buckets: bins 1 to halfSize split evenly, DC never read
+		constexpr int32_t HalfSize = 16;
+		constexpr int32_t NumBands = 4;
+		SynthDSP::FBandMatrix matrix;
+		matrix.BuildLinearBuckets(NumBands, HalfSize);
+		SYNTHDSP_CHECK(matrix.GetNumBands() == NumBands);
+
+		std::vector<float> bins(HalfSize + 1, 1.0f);
+		bins[0] = 1000.0f;
+		std::vector<float> bands(NumBands);
+		matrix.Apply(bins.data(), bands.data());
+		for (float band : bands) SYNTHDSP_CHECK_NEAR(band, 1.0, 1.0e-6);
+
+		// Band b averages bins 1 + 4b to 4 + 4b
+		const std::vector<float> ramp = MakeBinIndexRamp(HalfSize);
+		matrix.Apply(ramp.data(), bands.data());
+		for (int32_t band = 0; band < NumBands; band++) SYNTHDSP_CHECK_NEAR(bands[band], 2.5 + 4.0 * band, 1.0e-5);
+	}
+
+	void TestHardEdged()
+	{
+		constexpr int32_t HalfSize = 32;
+		const float edges[] = { 1.0f, 3.0f, 8.0f, 8.2f, 32.0f };
+		constexpr int32_t NumBands = 4;
+		SynthDSP::FBandMatrix matrix;
+		matrix.BuildHardEdged(edges, NumBands, HalfSize);
+		SYNTHDSP_CHECK(matrix.GetNumBands() == NumBands);
+
+		const std::vector<float> ramp = MakeBinIndexRamp(HalfSize);
+		std::vector<float> bands(NumBands);
+		matrix.Apply(ramp.data(), bands.data());
+		// [1, 3) reads bins 1 and 2, [3, 8) reads 3 to 7
+		SYNTHDSP_CHECK_NEAR(bands[0], 1.5, 1.0e-5);
+		SYNTHDSP_CHECK_NEAR(bands[1], 5.0, 1.0e-5);
+		// Narrower than a bin, takes the nearest one
+		SYNTHDSP_CHECK_NEAR(bands[2], 8.0, 1.0e-5);
+		// [8.2, 32) reads 9 to 31
+		SYNTHDSP_CHECK_NEAR(bands[3], 20.0, 1.0e-4);
+	}
+
+	void TestTriangularWeightsSumToOne()
+	{
+		constexpr int32_t HalfSize = 256;
+		constexpr int32_t NumBands = 12;
+		std::vector<float> edges(NumBands + 1);
+		std::vector<float> centres(NumBands);
+		// Log spaced so the low bands are narrower than a bin and hit the two bin fallback
+		for (int32_t i = 0; i <= NumBands; i++) edges[i] = 1.0f * std::pow(HalfSize / 1.0f, (float)i / NumBands);
+		for (int32_t band = 0; band < NumBands; band++) centres[band] = std::sqrt(edges[band] * edges[band + 1]);
+
+		SynthDSP::FBandMatrix matrix;
+		matrix.BuildTriangular(edges.data(), centres.data(), NumBands, HalfSize);
+		SYNTHDSP_CHECK(matrix.GetNumBands() == NumBands);
+
+		// Normalized weights turn a flat spectrum into flat bands
+		const std::vector<float> flat(HalfSize + 1, 0.75f);
+		std::vector<float> bands(NumBands);
+		matrix.Apply(flat.data(), bands.data());
+		for (float band : bands) SYNTHDSP_CHECK_NEAR(band, 0.75, 1.0e-5);
+
+		// And a ramp into band outputs that rise with the centres and stay close to them
+		const std::vector<float> ramp = MakeBinIndexRamp(HalfSize);
+		matrix.Apply(ramp.data(), bands.data());
+		for (int32_t band = 0; band < NumBands; band++)
+		{
+			if (band > 0) SYNTHDSP_CHECK(bands[band] >= bands[band - 1]);
+			SYNTHDSP_CHECK_NEAR(bands[band], centres[band], 0.25 * (edges[band + 1] - edges[band]) + 1.0);
+		}
+	}
+
+	void TestRebuildResets()
+	{
+		SynthDSP::FBandMatrix matrix;
+		matrix.BuildLinearBuckets(8, 64);
+		matrix.BuildLinearBuckets(2, 64);
+		SYNTHDSP_CHECK(matrix.GetNumBands() == 2);
+
+		const std::vector<float> flat(65, 1.0f);
+		std::vector<float> bands(2);
+		matrix.Apply(flat.data(), bands.data());
+		SYNTHDSP_CHECK_NEAR(bands[0], 1.0, 1.0e-6);
+		SYNTHDSP_CHECK_NEAR(bands[1], 1.0, 1.0e-6);
+	}
+}
+
+int main()
+{
+	TestLinearBuckets();
+	TestHardEdged();
+	TestTriangularWeightsSumToOne();
+	TestRebuildResets();
+	return SynthDSPTest::Finish("BandMatrixTest");
+}
@@ -0,0 +1,107 @@
+#include "SynthDSPTest.h"
+#include "SynthDSP/Quantize.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	void TestUInt8RoundTrip()
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> decibels(-60.0f, 60.0f);
+
+		// Odd count so both the vector loop and the scalar tail run
+		constexpr int32_t Count = 1027;
+		std::vector<float> values(Count);
+		for (float& value : values) value = decibels(random);
+
+		std::vector<uint8_t> codes(Count);
+		float scale = 0.0f;
+		float offset = 0.0f;
+		SynthDSP::QuantizeUInt8(values.data(), Count, codes.data(), scale, offset);
+
+		std::vector<float> restored(Count);
+		SynthDSP::DequantizeUInt8(codes.data(), Count, scale, offset, restored.data());
+		for (int32_t i = 0; i < Count; i++) SYNTHDSP_CHECK_NEAR(restored[i], values[i], 0.5 * scale + 1.0e-5);
+	}
+
+	void TestUInt8Constant()
+	{
+		// No range to spread the codes over, every value comes back exactly
+		const std::vector<float> values(9, -12.5f);
+		std::vector<uint8_t> codes(values.size());
+		float scale = 0.0f;
+		float offset = 0.0f;
+		SynthDSP::QuantizeUInt8(values.data(), (int32_t)values.size(), codes.data(), scale, offset);
+		SYNTHDSP_CHECK(scale == 0.0f);
+
+		std::vector<float> restored(values.size());
+		SynthDSP::DequantizeUInt8(codes.data(), (int32_t)codes.size(), scale, offset, restored.data());
+		for (float value : restored) SYNTHDSP_CHECK(value == -12.5f);
+	}
+
+	void TestHalfRoundTrip()
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> decibels(-60.0f, 60.0f);
+
+		constexpr int32_t Count = 515;
+		std::vector<float> values(Count);
+		for (float& value : values) value = decibels(random);
+		// Zeros, denormal halves and the largest finite half all have their own paths
+		values[0] = 0.0f;
+		values[1] = -0.0f;
+		values[2] = 3.0e-6f;
+		values[3] = -6.1e-5f;
+		values[4] = 65504.0f;
+
+		std::vector<uint16_t> halves(Count);
+		SynthDSP::QuantizeHalf(values.data(), Count, halves.data());
+		std::vector<float> restored(Count);
+		SynthDSP::DequantizeHalf(halves.data(), Count, restored.data());
+
+		// 11 significant bits, so round to nearest is within 2^-11 relative, denormals within half their step
+		for (int32_t i = 0; i < Count; i++)
+		{
+			SYNTHDSP_CHECK_NEAR(restored[i], values[i], std::fabs(values[i]) * (1.0 / 2048.0) + 3.0e-8);
+		}
+
+		uint32_t negativeZeroBits;
+		std::memcpy(&negativeZeroBits, &restored[1], sizeof(negativeZeroBits));
+		SYNTHDSP_CHECK(negativeZeroBits == 0x80000000u);
+	}
+
+	void TestHalfRounding()
+	{
+		// 1 + 2^-11 is exactly between two halves and rounds down to the even one, 1 + 3 * 2^-11 rounds up
+		SYNTHDSP_CHECK(SynthDSP::FloatToHalf(1.0f) == 0x3C00);
+		SYNTHDSP_CHECK(SynthDSP::FloatToHalf(1.0f + 1.0f / 2048.0f) == 0x3C00);
+		SYNTHDSP_CHECK(SynthDSP::FloatToHalf(1.0f + 3.0f / 2048.0f) == 0x3C02);
+		SYNTHDSP_CHECK(SynthDSP::FloatToHalf(-2.0f) == 0xC000);
+		SYNTHDSP_CHECK(SynthDSP::FloatToHalf(1.0e6f) == 0x7C00);
+
+		// Every finite half survives half -> float -> half unchanged
+		for (uint32_t half = 0; half < 0x10000; half++)
+		{
+			if ((half & 0x7C00) == 0x7C00) continue;
+			const uint16_t bits = (uint16_t)half;
+			float value;
+			SynthDSP::DequantizeHalf(&bits, 1, &value);
+			if (SynthDSP::FloatToHalf(value) != bits)
+			{
+				SYNTHDSP_CHECK(SynthDSP::FloatToHalf(value) == bits);
+				break;
+			}
+		}
+	}
+}
+
+int main()
+{
+	TestUInt8RoundTrip();
+	TestUInt8Constant();
+	TestHalfRoundTrip();
+	TestHalfRounding();
+	return SynthDSPTest::Finish("QuantizeTest");
+}
@@ -0,0 +1,113 @@
+#include "SynthDSPTest.h"
+#include "SynthDSP/RealFFT.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr double Pi = 3.14159265358979323846;
+
+	// |X[k]|^2 for bins 0 to size / 2, straight from the definition in double precision
+	std::vector<double> NaivePowerSpectrum(const std::vector<float>& samples)
+	{
+		const int32_t size = (int32_t)samples.size();
+		std::vector<double> power(size / 2 + 1);
+		for (int32_t k = 0; k <= size / 2; k++)
+		{
+			double binRe = 0.0;
+			double binIm = 0.0;
+			for (int32_t n = 0; n < size; n++)
+			{
+				const double angle = -2.0 * Pi * k * n / size;
+				binRe += samples[n] * std::cos(angle);
+				binIm += samples[n] * std::sin(angle);
+			}
+			power[k] = binRe * binRe + binIm * binIm;
+		}
+		return power;
+	}
+
+	void CheckAgainstNaiveDFT(SynthDSP::FRealFFT& fft, const std::vector<float>& samples, int32_t numAvailable)
+	{
+		const int32_t size = (int32_t)samples.size();
+		const std::vector<float> window(size, 1.0f);
+
+		// LoadFrame zero pads past numAvailable, so the reference sees the same zeros
+		std::vector<float> padded(samples);
+		std::fill(padded.begin() + numAvailable, padded.end(), 0.0f);
+		const std::vector<double> expected = NaivePowerSpectrum(padded);
+
+		fft.Prepare(size);
+		fft.LoadFrame(samples.data(), numAvailable, 1.0f, window.data());
+		fft.Forward();
+		std::vector<float> power(size / 2 + 1);
+		fft.PowerSpectrum(power.data());
+
+		// Single precision butterflies, so the error is relative to the loudest bin rather than each bin
+		const double peak = *std::max_element(expected.begin(), expected.end());
+		for (int32_t k = 0; k <= size / 2; k++)
+		{
+			SYNTHDSP_CHECK_NEAR(power[k], expected[k], 1.0e-4 * peak + 1.0e-6);
+		}
+	}
+
+	void TestRandomFrames()
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+
+		// One FFT reused across sizes also covers Prepare rebuilding its tables
+		SynthDSP::FRealFFT fft;
+		for (int32_t size = 4; size <= 2048; size *= 2)
+		{
+			std::vector<float> samples(size);
+			for (float& value : samples) value = sample(random);
+			CheckAgainstNaiveDFT(fft, samples, size);
+			CheckAgainstNaiveDFT(fft, samples, size / 2 + 1);
+		}
+	}
+
+	void TestPureTone()
+	{
+		// A whole number of cycles lands all the power in one bin
+		constexpr int32_t Size = 256;
+		constexpr int32_t ToneBin = 19;
+		std::vector<float> samples(Size);
+		for (int32_t n = 0; n < Size; n++) samples[n] = (float)std::cos(2.0 * Pi * ToneBin * n / Size);
+
+		SynthDSP::FRealFFT fft;
+		const std::vector<float> window(Size, 1.0f);
+		fft.Prepare(Size);
+		fft.LoadFrame(samples.data(), Size, 1.0f, window.data());
+		fft.Forward();
+		std::vector<float> power(Size / 2 + 1);
+		fft.PowerSpectrum(power.data());
+
+		const double tonePower = (Size / 2.0) * (Size / 2.0);
+		SYNTHDSP_CHECK_NEAR(power[ToneBin], tonePower, 1.0e-4 * tonePower);
+		for (int32_t k = 0; k <= Size / 2; k++)
+		{
+			if (k != ToneBin) SYNTHDSP_CHECK(power[k] < 1.0e-6 * tonePower);
+		}
+	}
+
+	void TestDCAndNyquist()
+	{
+		// The split step handles bin 0 and bin halfSize separately from the rest
+		constexpr int32_t Size = 64;
+		std::vector<float> samples(Size);
+		for (int32_t n = 0; n < Size; n++) samples[n] = 0.25f + ((n & 1) ? -0.5f : 0.5f);
+
+		SynthDSP::FRealFFT fft;
+		CheckAgainstNaiveDFT(fft, samples, Size);
+	}
+}
+
+int main()
+{
+	TestRandomFrames();
+	TestPureTone();
+	TestDCAndNyquist();
+	return SynthDSPTest::Finish("RealFFTTest");
+}
@@ -0,0 +1,122 @@
+#include "SynthDSPTest.h"
+#include "SynthDSP/SpectrumMath.h"
+#include "SynthDSP/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+namespace
+{
+	// Measured worst cases are ~1.5e-4 for log2, ~7e-5 relative for exp2 and ~2.7e-4 for the power curve
+	constexpr double FastLog2Tolerance = 2.0e-4;
+	constexpr double FastExp2RelativeTolerance = 1.0e-4;
+	constexpr double PowerCurveTolerance = 3.0e-4;
+
+	void TestFastLog2()
+	{
+		// The normalized spectrum lives in [0, 1], but band levels run well above it too
+		double worstError = 0.0;
+		for (int32_t i = 1; i <= 1000000; i++)
+		{
+			const float x = i / 1000000.0f;
+			worstError = std::max(worstError, std::fabs(SynthDSP::FastLog2(x) - std::log2((double)x)));
+		}
+		for (int32_t i = 0; i <= 1000000; i++)
+		{
+			const float x = 1.0f + i * (1023.0f / 1000000.0f);
+			worstError = std::max(worstError, std::fabs(SynthDSP::FastLog2(x) - std::log2((double)x)));
+		}
+		SYNTHDSP_CHECK_NEAR(worstError, 0.0, FastLog2Tolerance);
+	}
+
+	void TestFastExp2()
+	{
+		double worstError = 0.0;
+		for (int32_t i = 0; i <= 1000000; i++)
+		{
+			const float p = -20.0f + i * (40.0f / 1000000.0f);
+			const double expected = std::exp2((double)p);
+			worstError = std::max(worstError, std::fabs(SynthDSP::FastExp2(p) - expected) / expected);
+		}
+		SYNTHDSP_CHECK_NEAR(worstError, 0.0, FastExp2RelativeTolerance);
+
+		// Far below the smallest normal it flushes towards zero instead of wrapping
+		SYNTHDSP_CHECK(SynthDSP::FastExp2(-1000.0f) >= 0.0f);
+		SYNTHDSP_CHECK(SynthDSP::FastExp2(-1000.0f) < 1.0e-37f);
+	}
+
+	void TestFastLog2Exp2Float4()
+	{
+		// The four wide versions run the same arithmetic, every lane has to track the scalar result
+		double worstLog2 = 0.0;
+		double worstExp2 = 0.0;
+		for (int32_t i = 0; i < 100000; i += 4)
+		{
+			float x[4];
+			float p[4];
+			for (int32_t lane = 0; lane < 4; lane++)
+			{
+				x[lane] = (i + lane) / 100000.0f;
+				p[lane] = -30.0f + (i + lane) * (30.0f / 100000.0f);
+			}
+
+			float log2[4];
+			float exp2[4];
+			SynthDSP::Store4(SynthDSP::FastLog2_4(SynthDSP::Load4(x)), log2);
+			SynthDSP::Store4(SynthDSP::FastExp2_4(SynthDSP::Load4(p)), exp2);
+			for (int32_t lane = 0; lane < 4; lane++)
+			{
+				worstLog2 = std::max(worstLog2, (double)std::fabs(log2[lane] - SynthDSP::FastLog2(x[lane])));
+				const float expected = SynthDSP::FastExp2(p[lane]);
+				worstExp2 = std::max(worstExp2, (double)std::fabs(exp2[lane] - expected) / expected);
+			}
+		}
+		SYNTHDSP_CHECK_NEAR(worstLog2, 0.0, 1.0e-5);
+		SYNTHDSP_CHECK_NEAR(worstExp2, 0.0, 1.0e-6);
+	}
+
+	void TestNormalizeSpectrum()
+	{
+		constexpr float Clamp = 60.0f;
+		constexpr int32_t Count = 243;
+		std::vector<float> decibels(Count);
+		for (int32_t i = 0; i < Count; i++) decibels[i] = -80.0f + i * (160.0f / (Count - 1));
+
+		std::vector<float> normalized(Count);
+		for (float powerFactor : { 1.0f, 2.0f, 3.0f, 4.0f, 0.5f, 1.5f, 2.5f })
+		{
+			SynthDSP::NormalizeSpectrum(decibels.data(), normalized.data(), Count, Clamp, powerFactor);
+
+			// Whole powers are plain multiplies, anything else goes through the fast log/exp pair
+			const bool isIntegerPower = powerFactor == std::floor(powerFactor);
+			for (int32_t i = 0; i < Count; i++)
+			{
+				const double linear = (std::min(std::max((double)decibels[i], -(double)Clamp), (double)Clamp) + Clamp) / (2.0 * Clamp);
+				const double expected = std::pow(linear, (double)powerFactor);
+				SYNTHDSP_CHECK_NEAR(normalized[i], expected, isIntegerPower ? 1.0e-6 : PowerCurveTolerance);
+			}
+		}
+	}
+
+	void TestPowerToDecibels()
+	{
+		std::vector<float> values = { 1.0f, 10.0f, 0.001f, 0.0f };
+		SynthDSP::PowerToDecibels(values.data(), (int32_t)values.size(), 2.0f, 1.0e-10f);
+		SYNTHDSP_CHECK_NEAR(values[0], 10.0 * std::log10(2.0), 1.0e-4);
+		SYNTHDSP_CHECK_NEAR(values[1], 10.0 * std::log10(20.0), 1.0e-4);
+		SYNTHDSP_CHECK_NEAR(values[2], 10.0 * std::log10(0.002), 1.0e-4);
+		// Silence floors at the minimum power instead of going to -inf
+		SYNTHDSP_CHECK_NEAR(values[3], -100.0, 1.0e-3);
+	}
+}
+
+int main()
+{
+	TestFastLog2();
+	TestFastExp2();
+	TestFastLog2Exp2Float4();
+	TestNormalizeSpectrum();
+	TestPowerToDecibels();
+	return SynthDSPTest::Finish("SpectrumMathTest");
+}
@@ -0,0 +1,119 @@
+#include "SynthDSPTest.h"
+#include "SynthDSP/SpscRing.h"
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::vector<float> MakeSequence(float first, int32_t count)
+	{
+		std::vector<float> samples(count);
+		for (int32_t i = 0; i < count; i++) samples[i] = first + i;
+		return samples;
+	}
+
+	void TestCapacityRounding()
+	{
+		SynthDSP::FSpscRing ring;
+		ring.Reset(100);
+		SYNTHDSP_CHECK(ring.GetCapacity() == 128);
+		ring.Reset(0);
+		SYNTHDSP_CHECK(ring.GetCapacity() == 1);
+	}
+
+	void TestWraparound()
+	{
+		// Writes and reads of awkward sizes walk the indices around the buffer many times over
+		SynthDSP::FSpscRing ring;
+		ring.Reset(16);
+
+		float nextWritten = 0.0f;
+		float nextExpected = 0.0f;
+		std::vector<float> readBuffer(16);
+		for (int32_t round = 0; round < 200; round++)
+		{
+			const int32_t writeCount = 1 + (round * 7) % 13;
+			const std::vector<float> samples = MakeSequence(nextWritten, writeCount);
+			const int32_t written = ring.Write(samples.data(), writeCount);
+			nextWritten += written;
+
+			const int32_t read = ring.Read(readBuffer.data(), 1 + (round * 5) % 11);
+			for (int32_t i = 0; i < read; i++) SYNTHDSP_CHECK(readBuffer[i] == nextExpected + i);
+			nextExpected += read;
+			SYNTHDSP_CHECK(ring.GetNumReadable() == (int32_t)(nextWritten - nextExpected));
+		}
+	}
+
+	void TestFullAndSkip()
+	{
+		SynthDSP::FSpscRing ring;
+		ring.Reset(8);
+
+		// A full ring drops what doesn't fit
+		const std::vector<float> samples = MakeSequence(0.0f, 12);
+		SYNTHDSP_CHECK(ring.Write(samples.data(), 12) == 8);
+		SYNTHDSP_CHECK(ring.Write(samples.data(), 1) == 0);
+
+		// Skip keeps the newest samples
+		ring.Skip(3);
+		SYNTHDSP_CHECK(ring.GetNumReadable() == 3);
+		std::vector<float> readBuffer(8);
+		SYNTHDSP_CHECK(ring.Read(readBuffer.data(), 8) == 3);
+		SYNTHDSP_CHECK(readBuffer[0] == 5.0f && readBuffer[1] == 6.0f && readBuffer[2] == 7.0f);
+
+		// Skipping to more than is buffered leaves it alone
+		ring.Write(samples.data(), 2);
+		ring.Skip(5);
+		SYNTHDSP_CHECK(ring.GetNumReadable() == 2);
+	}
+
+	void TestProducerConsumerThreads()
+	{
+		// The producer never drops here, it spins until there's room, so the reader must see every sample in order
+		constexpr int32_t Total = 1 << 20;
+		SynthDSP::FSpscRing ring;
+		ring.Reset(256);
+
+		std::thread producer([&ring]()
+		{
+			float next = 0.0f;
+			float block[37];
+			while (next < Total)
+			{
+				int32_t count = 0;
+				for (; count < 37 && next + count < Total; count++) block[count] = next + count;
+				int32_t written = 0;
+				while (written < count)
+				{
+					written += ring.Write(block + written, count - written);
+					if (written < count) std::this_thread::yield();
+				}
+				next += count;
+			}
+		});
+
+		bool inOrder = true;
+		float expected = 0.0f;
+		float block[53];
+		while (expected < Total)
+		{
+			const int32_t read = ring.Read(block, 53);
+			for (int32_t i = 0; i < read; i++) inOrder &= block[i] == expected + i;
+			expected += read;
+			if (read == 0) std::this_thread::yield();
+		}
+
+		producer.join();
+		SYNTHDSP_CHECK(inOrder);
+		SYNTHDSP_CHECK(ring.GetNumReadable() == 0);
+	}
+}
+
+int main()
+{
+	TestCapacityRounding();
+	TestWraparound();
+	TestFullAndSkip();
+	TestProducerConsumerThreads();
+	return SynthDSPTest::Finish("SpscRingTest");
+}
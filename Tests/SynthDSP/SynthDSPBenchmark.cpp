@@ -0,0 +1,185 @@
+#include "SynthDSP/BandMatrix.h"
+#include "SynthDSP/Envelope.h"
+#include "SynthDSP/Quantize.h"
+#include "SynthDSP/RealFFT.h"
+#include "SynthDSP/SpectrumMath.h"
+#include "SynthDSP/Window.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/**
+ * Microbenchmark of the per frame kernels, outside the engine so a change to one can be timed on its own.
+ * Prints the best of several runs in nanoseconds per call. Pass a number to scale the iteration counts.
+ */
+namespace
+{
+	constexpr int32_t NumRuns = 5;
+
+	// Written by every timed call so the optimizer can't drop the work
+	volatile float Sink = 0.0f;
+
+	template<typename Function>
+	void Measure(const char* name, int32_t iterations, Function&& function)
+	{
+		double bestNanoseconds = 1.0e30;
+		for (int32_t run = 0; run < NumRuns; run++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (int32_t i = 0; i < iterations; i++) function();
+			const auto end = std::chrono::steady_clock::now();
+			bestNanoseconds = std::min(bestNanoseconds, std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+		}
+		std::printf("%-36s %12.1f ns\n", name, bestNanoseconds);
+	}
+
+	std::vector<float> MakeNoise(int32_t count, float low, float high)
+	{
+		std::mt19937 random(99);
+		std::uniform_real_distribution<float> value(low, high);
+		std::vector<float> samples(count);
+		for (float& sample : samples) sample = value(random);
+		return samples;
+	}
+
+	void BenchmarkFFT(int32_t fftSize, int32_t iterations)
+	{
+		SynthDSP::FRealFFT fft;
+		fft.Prepare(fftSize);
+		std::vector<float> window(fftSize);
+		SynthDSP::BuildWindow(SynthDSP::EWindowType::Hann, fftSize, 1.0f, window.data());
+		const std::vector<float> samples = MakeNoise(fftSize, -1.0f, 1.0f);
+		std::vector<float> power(fftSize / 2 + 1);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "RealFFT load+forward+power %d", fftSize);
+		Measure(name, iterations, [&]()
+		{
+			fft.LoadFrame(samples.data(), fftSize, 1.0f, window.data());
+			fft.Forward();
+			fft.PowerSpectrum(power.data());
+			Sink = power[fftSize / 4];
+		});
+	}
+
+	void BenchmarkBandMatrix(int32_t fftSize, int32_t numBands, int32_t iterations)
+	{
+		const int32_t halfSize = fftSize / 2;
+		std::vector<float> edges(numBands + 1);
+		std::vector<float> centres(numBands);
+		for (int32_t i = 0; i <= numBands; i++) edges[i] = std::pow((float)halfSize, (float)i / numBands);
+		for (int32_t band = 0; band < numBands; band++) centres[band] = std::sqrt(edges[band] * edges[band + 1]);
+
+		SynthDSP::FBandMatrix matrix;
+		matrix.BuildTriangular(edges.data(), centres.data(), numBands, halfSize);
+		const std::vector<float> bins = MakeNoise(halfSize + 1, 0.0f, 1.0f);
+		std::vector<float> bands(numBands);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "BandMatrix triangular %d -> %d", halfSize, numBands);
+		Measure(name, iterations, [&]()
+		{
+			matrix.Apply(bins.data(), bands.data());
+			Sink = bands[0];
+		});
+	}
+
+	void BenchmarkSpectrumMath(int32_t count, int32_t iterations)
+	{
+		const std::vector<float> decibels = MakeNoise(count, -80.0f, 80.0f);
+		std::vector<float> normalized(count);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "NormalizeSpectrum x2 %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::NormalizeSpectrum(decibels.data(), normalized.data(), count, 60.0f, 2.0f);
+			Sink = normalized[0];
+		});
+
+		std::snprintf(name, sizeof(name), "NormalizeSpectrum x1.5 %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::NormalizeSpectrum(decibels.data(), normalized.data(), count, 60.0f, 1.5f);
+			Sink = normalized[0];
+		});
+
+		std::vector<float> power = MakeNoise(count, 0.0f, 1.0f);
+		std::snprintf(name, sizeof(name), "PowerToDecibels %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::PowerToDecibels(power.data(), count, 1.0f, 1.0e-10f);
+			Sink = power[0];
+		});
+	}
+
+	void BenchmarkEnvelopes(int32_t count, int32_t iterations)
+	{
+		const std::vector<float> input = MakeNoise(count, 0.0f, 1.0f);
+		std::vector<float> envelope(count, 0.0f);
+		std::vector<float> peak(count, 0.0f);
+		std::vector<float> timers(count, 0.0f);
+		constexpr float DeltaTime = 1.0f / 60.0f;
+		SynthDSP::FEnvelopeSettings settings;
+		settings.attackCoefficient = SynthDSP::EnvelopeCoefficient(0.01f, DeltaTime);
+		settings.releaseCoefficient = SynthDSP::EnvelopeCoefficient(0.2f, DeltaTime);
+		settings.peakHoldTime = 0.25f;
+		settings.peakReleaseCoefficient = SynthDSP::EnvelopeCoefficient(0.5f, DeltaTime);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "UpdateEnvelopes %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::UpdateEnvelopes(input.data(), envelope.data(), peak.data(), timers.data(), count, DeltaTime, settings);
+			Sink = peak[0];
+		});
+	}
+
+	void BenchmarkDequantize(int32_t count, int32_t iterations)
+	{
+		const std::vector<float> values = MakeNoise(count, -60.0f, 60.0f);
+		std::vector<uint8_t> codes(count);
+		float scale = 0.0f;
+		float offset = 0.0f;
+		SynthDSP::QuantizeUInt8(values.data(), count, codes.data(), scale, offset);
+		std::vector<uint16_t> halves(count);
+		SynthDSP::QuantizeHalf(values.data(), count, halves.data());
+		std::vector<float> restored(count);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "DequantizeUInt8 %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::DequantizeUInt8(codes.data(), count, scale, offset, restored.data());
+			Sink = restored[0];
+		});
+
+		std::snprintf(name, sizeof(name), "DequantizeHalf %d", count);
+		Measure(name, iterations, [&]()
+		{
+			SynthDSP::DequantizeHalf(halves.data(), count, restored.data());
+			Sink = restored[0];
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const double scale = argc > 1 ? std::max(std::atof(argv[1]), 0.001) : 1.0;
+	const auto iterations = [scale](int32_t count) { return std::max((int32_t)(count * scale), 1); };
+
+	BenchmarkFFT(1024, iterations(20000));
+	BenchmarkFFT(2048, iterations(10000));
+	BenchmarkFFT(4096, iterations(5000));
+	// 64 bands is the tracks' default spectrumResolution
+	BenchmarkBandMatrix(2048, 64, iterations(100000));
+	BenchmarkSpectrumMath(1024, iterations(100000));
+	BenchmarkEnvelopes(64, iterations(1000000));
+	BenchmarkEnvelopes(1024, iterations(100000));
+	BenchmarkDequantize(1024, iterations(100000));
+	return 0;
+}
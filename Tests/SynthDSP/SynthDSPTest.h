@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * Just enough of a test harness for the standalone kernel tests.
+ * Checks log and count their failures instead of stopping, so one run reports everything that's off.
+ */
+namespace SynthDSPTest
+{
+	inline int32_t& FailureCount()
+	{
+		static int32_t failures = 0;
+		return failures;
+	}
+
+	inline void Check(bool condition, const char* expression, const char* file, int line)
+	{
+		if (condition) return;
+		std::printf("%s(%d): Check failed: %s\n", file, line, expression);
+		FailureCount()++;
+	}
+
+	inline void CheckNear(double actual, double expected, double tolerance, const char* expression, const char* file, int line)
+	{
+		if (std::fabs(actual - expected) <= tolerance) return;
+		std::printf("%s(%d): Check failed: %s, got %g expected %g (tolerance %g)\n", file, line, expression, actual, expected, tolerance);
+		FailureCount()++;
+	}
+
+	// Returned from main, prints a summary line for ctest's log
+	inline int Finish(const char* testName)
+	{
+		if (FailureCount() == 0)
+		{
+			std::printf("%s: passed\n", testName);
+			return 0;
+		}
+
+		std::printf("%s: %d check(s) failed\n", testName, FailureCount());
+		return 1;
+	}
+}
+
+#define SYNTHDSP_CHECK(condition) SynthDSPTest::Check((condition), #condition, __FILE__, __LINE__)
+#define SYNTHDSP_CHECK_NEAR(actual, expected, tolerance) SynthDSPTest::CheckNear((actual), (expected), (tolerance), #actual, __FILE__, __LINE__)